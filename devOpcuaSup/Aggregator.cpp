@@ -0,0 +1,153 @@
+/*************************************************************************\
+* Copyright (c) 2026 ITER Organization.
+* This module is distributed subject to a Software License Agreement found
+* in file LICENSE that is included with this distribution.
+\*************************************************************************/
+
+/*
+ *  Author: agent <agent@local>
+ */
+
+#include <iostream>
+#include <stdexcept>
+#include <limits>
+#include <cmath>
+
+#define epicsExportSharedSymbols
+#include "devOpcua.h"
+#include "Aggregator.h"
+
+namespace DevOpcua {
+
+Aggregator::Function
+Aggregator::functionFromString (const std::string &name)
+{
+    if (name == "last")
+        return last;
+    else if (name == "min")
+        return min;
+    else if (name == "max")
+        return max;
+    else if (name == "mean")
+        return mean;
+    else if (name == "rms")
+        return rms;
+    else
+        throw std::runtime_error(SB() << "illegal aggregate function '" << name << "'");
+}
+
+const char *
+Aggregator::functionString (const Function function)
+{
+    switch (function) {
+    case last: return "last";
+    case min:  return "min";
+    case max:  return "max";
+    case mean: return "mean";
+    case rms:  return "rms";
+    }
+    return "?";
+}
+
+Aggregator::Aggregator (const Function function, const epicsUInt32 samples)
+    : function(function)
+    , samples(samples)
+    , inChunk(0)
+    , window(0)
+    , lastValue(0.0)
+    , lastTimeStamp()
+    , windows(0)
+{
+    reset();
+}
+
+void
+Aggregator::reset ()
+{
+    count = 0;
+    minimum = std::numeric_limits<double>::infinity();
+    maximum = -std::numeric_limits<double>::infinity();
+    sum = 0.0;
+    sumOfSquares = 0.0;
+}
+
+void
+Aggregator::add (const double value, const epicsTimeStamp &ts)
+{
+    chunk[inChunk++] = value;
+    count++;
+    lastValue = value;
+    lastTimeStamp = ts;
+    if (inChunk == chunkSize)
+        fold();
+}
+
+void
+Aggregator::fold ()
+{
+    // One accumulator per lane: no dependency between consecutive samples,
+    // the inner loop maps onto SIMD registers
+    double lo[lanes], hi[lanes], s[lanes], sq[lanes];
+    for (unsigned int k = 0; k < lanes; k++) {
+        lo[k] = minimum;
+        hi[k] = maximum;
+        s[k] = 0.0;
+        sq[k] = 0.0;
+    }
+    unsigned int i = 0;
+    for (; i + lanes <= inChunk; i += lanes) {
+        for (unsigned int k = 0; k < lanes; k++) {
+            const double v = chunk[i + k];
+            lo[k] = v < lo[k] ? v : lo[k];
+            hi[k] = v > hi[k] ? v : hi[k];
+            s[k] += v;
+            sq[k] += v * v;
+        }
+    }
+    for (; i < inChunk; i++) {
+        const double v = chunk[i];
+        lo[0] = v < lo[0] ? v : lo[0];
+        hi[0] = v > hi[0] ? v : hi[0];
+        s[0] += v;
+        sq[0] += v * v;
+    }
+    for (unsigned int k = 0; k < lanes; k++) {
+        minimum = lo[k] < minimum ? lo[k] : minimum;
+        maximum = hi[k] > maximum ? hi[k] : maximum;
+        sum += s[k];
+        sumOfSquares += sq[k];
+    }
+    inChunk = 0;
+}
+
+double
+Aggregator::take (epicsTimeStamp &ts)
+{
+    double result = lastValue;
+
+    fold();
+    if (count) {
+        switch (function) {
+        case last: result = lastValue; break;
+        case min:  result = minimum; break;
+        case max:  result = maximum; break;
+        case mean: result = sum / count; break;
+        case rms:  result = std::sqrt(sumOfSquares / count); break;
+        }
+    }
+    ts = lastTimeStamp;
+    reset();
+    window++;
+    windows++;
+    return result;
+}
+
+void
+Aggregator::show () const
+{
+    std::cout << " aggregate=" << functionString(function)
+              << " window=" << count << "/" << samples
+              << " windows=" << windows;
+}
+
+} // namespace DevOpcua
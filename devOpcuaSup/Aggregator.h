@@ -0,0 +1,120 @@
+/*************************************************************************\
+* Copyright (c) 2026 ITER Organization.
+* This module is distributed subject to a Software License Agreement found
+* in file LICENSE that is included with this distribution.
+\*************************************************************************/
+
+/*
+ *  Author: agent <agent@local>
+ */
+
+#ifndef DEVOPCUA_AGGREGATOR_H
+#define DEVOPCUA_AGGREGATOR_H
+
+#include <string>
+
+#include <epicsTime.h>
+#include <epicsTypes.h>
+
+namespace DevOpcua {
+
+/**
+ * @brief Aggregates a stream of samples over a window.
+ *
+ * Samples are queued in a small chunk buffer, which is drained into the
+ * window's accumulators in one call when it is full (and when the window
+ * is taken). The drain loop keeps independent partial accumulators per
+ * lane, so that the compiler can use SIMD instructions (sums are therefore
+ * added in a different order than the samples arrived).
+ * The window result is the minimum, maximum, mean, root mean square or
+ * last value of all samples in the window.
+ */
+class Aggregator
+{
+public:
+    enum Function { last, min, max, mean, rms };
+
+    /**
+     * @brief Get the aggregate function from its name.
+     *
+     * @param name  function name (last|min|max|mean|rms)
+     *
+     * @throws std::runtime_error on illegal name
+     */
+    static Function functionFromString(const std::string &name);
+
+    /**
+     * @brief Get the name of an aggregate function.
+     */
+    static const char *functionString(const Function function);
+
+    /**
+     * @brief Constructor.
+     *
+     * @param function  aggregate function
+     * @param samples   number of samples in a window (0 = no limit)
+     */
+    Aggregator(const Function function, const epicsUInt32 samples);
+
+    /**
+     * @brief Add a sample to the current window.
+     *
+     * @param value  sample value
+     * @param ts     sample time stamp
+     */
+    void add(const double value, const epicsTimeStamp &ts);
+
+    /**
+     * @brief Return true if the current window has reached its number of samples.
+     */
+    bool isFull() const { return samples && count >= samples; }
+
+    /**
+     * @brief Return true if the current window has no samples.
+     */
+    bool isEmpty() const { return count == 0; }
+
+    /**
+     * @brief Get the sequence number of the current window.
+     */
+    epicsUInt32 currentWindow() const { return window; }
+
+    /**
+     * @brief Take the result of the current window and start the next one.
+     *
+     * @param ts  [out] time stamp of the last sample in the window
+     *
+     * @return aggregated value
+     */
+    double take(epicsTimeStamp &ts);
+
+    /**
+     * @brief Print configuration and statistics on stdout.
+     */
+    void show() const;
+
+private:
+    void fold();
+    void reset();
+
+    static const unsigned int chunkSize = 64;
+    static const unsigned int lanes = 4;   /**< independent accumulators in fold() */
+
+    const Function function;           /**< aggregate function */
+    const epicsUInt32 samples;         /**< number of samples in a window (0 = no limit) */
+    double chunk[chunkSize];           /**< samples not folded yet */
+    unsigned int inChunk;              /**< number of samples in chunk */
+    epicsUInt32 count;                 /**< number of samples in the current window */
+    epicsUInt32 window;                /**< sequence number of the current window */
+    double minimum;                    /**< accumulators of the current window */
+    double maximum;
+    double sum;
+    double sumOfSquares;
+    double lastValue;                  /**< last sample */
+    epicsTimeStamp lastTimeStamp;      /**< time stamp of the last sample */
+    unsigned long windows;             /**< number of delivered windows */
+};
+
+} // namespace DevOpcua
+
+#endif // DEVOPCUA_AGGREGATOR_H
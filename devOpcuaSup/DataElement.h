@@ -444,6 +444,17 @@ public:
      */
     virtual void requestRecordProcessing(const ProcessReason reason) const = 0;
 
+    /**
+     * @brief Undo the bookkeeping of a processing request that was rejected.
+     *
+     * Called when the processing request for the attached record could not
+     * be queued (e.g. callback queue full), so that the next update requests
+     * processing again.
+     *
+     * @param reason  reason of the rejected request
+     */
+    virtual void processingRequestFailed(const ProcessReason reason) const = 0;
+
     const std::string name;                     /**< element name */
     static const char separator = '.';
 
@@ -0,0 +1,107 @@
+/*************************************************************************\
+* Copyright (c) 2026 ITER Organization.
+* This module is distributed subject to a Software License Agreement found
+* in file LICENSE that is included with this distribution.
+\*************************************************************************/
+
+/*
+ *  Author: agent <agent@local>
+ */
+
+#ifndef DEVOPCUA_DUPLICATEFILTER_H
+#define DEVOPCUA_DUPLICATEFILTER_H
+
+#include <epicsTypes.h>
+#include <epicsTime.h>
+#include <epicsAtomic.h>
+
+namespace DevOpcua {
+
+/**
+ * @brief Detects monitored updates that repeat the last value handed on.
+ *
+ * An update is a duplicate if value and status (and, in time stamp mode,
+ * the time stamp) are equal to those of the last update that was handed on.
+ *
+ * After a connection loss, the filter must be reset: the first update on
+ * the new connection is always handed on, even if it repeats the last value
+ * (the record has been set to INVALID in the meantime).
+ *
+ * check() and handedOn() are called by the thread that delivers the data,
+ * reset() can be called from any thread.
+ */
+template<typename V>
+class DuplicateFilter
+{
+public:
+    /**
+     * @brief Constructor.
+     *
+     * @param compareTimeStamps  a duplicate must also have the same time stamp
+     */
+    explicit DuplicateFilter(const bool compareTimeStamps = false)
+        : compareTimeStamps(compareTimeStamps)
+        , lastStatus(0)
+        , lastTimeStamp()
+        , hasLast(false)
+        , resetRequested(0)
+        , duplicates(0)
+    {}
+
+    /**
+     * @brief Check a monitored update, remember it if it is handed on.
+     *
+     * @param value   value of the update
+     * @param status  status code of the update
+     * @param ts      time stamp of the update
+     *
+     * @return true if the update is a duplicate (and has to be dropped)
+     */
+    bool check(const V &value, const epicsUInt32 status, const epicsTimeStamp &ts)
+    {
+        if (epics::atomic::compareAndSwap(resetRequested, 1, 0) == 1)
+            hasLast = false;
+        if (hasLast && status == lastStatus && value == last
+                && (!compareTimeStamps
+                    || (ts.secPastEpoch == lastTimeStamp.secPastEpoch && ts.nsec == lastTimeStamp.nsec))) {
+            epics::atomic::increment(duplicates);
+            return true;
+        }
+        handedOn(value, status, ts);
+        return false;
+    }
+
+    /**
+     * @brief Remember an update that is handed on without checking (e.g. read result).
+     */
+    void handedOn(const V &value, const epicsUInt32 status, const epicsTimeStamp &ts)
+    {
+        last = value;
+        lastStatus = status;
+        lastTimeStamp = ts;
+        hasLast = true;
+    }
+
+    /**
+     * @brief Forget the last update (e.g. after a connection loss).
+     */
+    void reset() { epics::atomic::set(resetRequested, 1); }
+
+    /**
+     * @brief Get the number of dropped duplicates.
+     */
+    int noOfDuplicates() const { return epics::atomic::get(duplicates); }
+
+private:
+    const bool compareTimeStamps;
+    V last;                          /**< last update handed on */
+    epicsUInt32 lastStatus;          /**< status of the last update handed on */
+    epicsTimeStamp lastTimeStamp;    /**< time stamp of the last update handed on */
+    bool hasLast;                    /**< last is valid */
+    int resetRequested;              /**< forget last before the next check */
+    int duplicates;                  /**< number of dropped duplicates */
+};
+
+} // namespace DevOpcua
+
+#endif // DEVOPCUA_DUPLICATEFILTER_H
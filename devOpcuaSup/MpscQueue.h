@@ -0,0 +1,97 @@
+/*************************************************************************\
+* Copyright (c) 2026 ITER Organization.
+* This module is distributed subject to a Software License Agreement found
+* in file LICENSE that is included with this distribution.
+\*************************************************************************/
+
+/*
+ *  Author: agent <agent@local>
+ */
+
+#ifndef DEVOPCUA_MPSCQUEUE_H
+#define DEVOPCUA_MPSCQUEUE_H
+
+#include <utility>
+
+#include <epicsAtomic.h>
+
+namespace DevOpcua {
+
+/**
+ * @brief Unbounded lock-free queue for many writers and a single reader.
+ *
+ * A linked list with a dummy node at the head. Writers append a node by
+ * swapping the tail pointer, then link the previous tail to it. A value
+ * is visible to the reader once its node is linked.
+ *
+ * There must be only one reader at a time
+ * (concurrent readers must be serialized by the caller).
+ */
+template<typename T>
+class MpscQueue
+{
+public:
+    MpscQueue()
+        : head(new Node)
+        , tail(head)
+    {}
+
+    ~MpscQueue()
+    {
+        T value;
+        while (pop(value)) {}
+        delete head;
+    }
+
+    /**
+     * @brief Append a value (writer side, any thread).
+     *
+     * @param value  value to move into the queue
+     */
+    void push(T &&value)
+    {
+        Node *node = new Node;
+        node->value = std::move(value);
+        void *prev = epics::atomic::get(tail);
+        void *seen;
+        while ((seen = epics::atomic::compareAndSwap(tail, prev, static_cast<void *>(node))) != prev)
+            prev = seen;
+        epics::atomic::set(static_cast<Node *>(prev)->next, static_cast<void *>(node));
+    }
+
+    /**
+     * @brief Take the oldest value (reader side).
+     *
+     * @param value  [out] oldest value
+     *
+     * @return false if no value is available
+     */
+    bool pop(T &value)
+    {
+        Node *next = static_cast<Node *>(epics::atomic::get(head->next));
+        if (!next)
+            return false;
+        value = std::move(next->value);
+        delete head;
+        head = next;
+        return true;
+    }
+
+    /**
+     * @brief Return true if no value is available to the reader (reader side).
+     */
+    bool isEmpty() const { return !epics::atomic::get(head->next); }
+
+private:
+    struct Node {
+        void *next = nullptr;
+        T value;
+    };
+
+    Node *head;                      /**< dummy node, its successor holds the oldest value (reader only) */
+    void *tail;                      /**< last node (writers) */
+};
+
+} // namespace DevOpcua
+
+#endif // DEVOPCUA_MPSCQUEUE_H
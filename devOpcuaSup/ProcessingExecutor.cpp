@@ -0,0 +1,175 @@
+/*************************************************************************\
+* Copyright (c) 2026 ITER Organization.
+* This module is distributed subject to a Software License Agreement found
+* in file LICENSE that is included with this distribution.
+\*************************************************************************/
+
+/*
+ *  Author: agent <agent@local>
+ */
+
+#include <iostream>
+#include <algorithm>
+
+#define epicsExportSharedSymbols
+#include "ProcessingExecutor.h"
+#include "RecordConnector.h"
+
+namespace DevOpcua {
+
+// Max. number of queued requests per record (one per pending reason, see RecordConnector)
+static const size_t requestsPerRecord = 4;
+// Max. size of the queue on overflow, as a multiple of the attached records' requests
+static const size_t maxExtension = 4;
+
+ProcessingExecutor::ProcessingExecutor (const std::string &name,
+                                        const unsigned int threads,
+                                        const unsigned int priority)
+    : name(name)
+    , priority(priority)
+    , noOfRecords(0)
+    , queue(requestsPerRecord)
+    , head(0)
+    , count(0)
+    , running(true)
+    , highWater(0)
+    , noOfRequests(0)
+    , noOfOverflows(0)
+    , noOfExtensions(0)
+    , noOfFallbacks(0)
+{
+    for (unsigned int i = 0; i < threads; i++) {
+        std::string threadName = name + "-" + std::to_string(i);
+        workers.emplace_back(new epicsThread(*this, threadName.c_str(),
+                                             epicsThreadGetStackSize(epicsThreadStackSmall),
+                                             priority));
+        workers.back()->start();
+    }
+}
+
+ProcessingExecutor::~ProcessingExecutor ()
+{
+    stop();
+}
+
+void
+ProcessingExecutor::resize (const size_t size)
+{
+    std::vector<Request> larger(size);
+    for (size_t i = 0; i < count; i++)
+        larger[i] = queue[(head + i) % queue.size()];
+    queue.swap(larger);
+    head = 0;
+}
+
+size_t
+ProcessingExecutor::maxQueueSize () const
+{
+    return maxExtension * std::max<size_t>(noOfRecords, 1) * requestsPerRecord;
+}
+
+void
+ProcessingExecutor::attach ()
+{
+    Guard G(lock);
+    noOfRecords++;
+    if (noOfRecords * requestsPerRecord > queue.size())
+        resize(noOfRecords * requestsPerRecord);
+}
+
+bool
+ProcessingExecutor::request (RecordConnector *pconnector, const ProcessReason reason)
+{
+    bool fallback = false;
+    {
+        Guard G(lock);
+        if (!running) {
+            noOfOverflows++;
+            return false;
+        }
+        if (count == queue.size()) {
+            // The record would stay active (PACT) or miss going INVALID
+            if (reason == ProcessReason::incomingData || reason == ProcessReason::none) {
+                noOfOverflows++;
+                return false;
+            }
+            if (queue.size() < maxQueueSize()) {
+                resize(std::min(2 * queue.size(), maxQueueSize()));
+                noOfExtensions++;
+            } else {
+                noOfFallbacks++;
+                fallback = true;
+            }
+        }
+        if (!fallback) {
+            queue[(head + count) % queue.size()] = Request{pconnector, reason};
+            count++;
+            if (count > highWater)
+                highWater = count;
+        }
+    }
+    if (fallback)
+        return pconnector->requestCallback(reason);
+    workToDo.signal();
+    return true;
+}
+
+void
+ProcessingExecutor::stop ()
+{
+    {
+        Guard G(lock);
+        if (!running)
+            return;
+        running = false;
+    }
+    for (auto &it : workers) {
+        workToDo.signal();
+        it->exitWait();
+    }
+}
+
+void
+ProcessingExecutor::run ()
+{
+    while (true) {
+        workToDo.wait();
+        while (true) {
+            Request req;
+            bool more;
+            {
+                Guard G(lock);
+                if (!running) {
+                    count = 0;
+                    workToDo.signal();   // pass on to the next worker
+                    return;
+                }
+                if (!count)
+                    break;
+                req = queue[head];
+                head = (head + 1) % queue.size();
+                count--;
+                more = count > 0;
+                noOfRequests++;
+            }
+            if (more)
+                workToDo.signal();       // wake up another worker
+            req.pconnector->process(req.reason);
+        }
+    }
+}
+
+void
+ProcessingExecutor::show () const
+{
+    Guard G(lock);
+    std::cout << " executor(threads/prio)=" << workers.size() << "/" << priority
+              << " queue=" << count << "/" << queue.size()
+              << "(" << highWater << " max)"
+              << " processed=" << noOfRequests
+              << " overflows=" << noOfOverflows
+              << " extensions=" << noOfExtensions
+              << " fallbacks=" << noOfFallbacks;
+}
+
+} // namespace DevOpcua
@@ -0,0 +1,124 @@
+/*************************************************************************\
+* Copyright (c) 2026 ITER Organization.
+* This module is distributed subject to a Software License Agreement found
+* in file LICENSE that is included with this distribution.
+\*************************************************************************/
+
+/*
+ *  Author: agent <agent@local>
+ */
+
+#ifndef DEVOPCUA_PROCESSINGEXECUTOR_H
+#define DEVOPCUA_PROCESSINGEXECUTOR_H
+
+#include <string>
+#include <vector>
+#include <memory>
+
+#include <epicsTypes.h>
+#include <epicsMutex.h>
+#include <epicsEvent.h>
+#include <epicsThread.h>
+
+#include "devOpcua.h"
+
+namespace DevOpcua {
+
+class RecordConnector;
+
+/**
+ * @brief A bounded queue with worker threads that process records.
+ *
+ * Replaces the shared EPICS callback queues for the records of one session,
+ * so that a busy session can not flood the queues that other drivers use.
+ *
+ * Processing requests (record and reason) are pushed by any thread into a
+ * queue that is sized from the number of attached records: a record has at
+ * most one queued request per reason (see RecordConnector), so the queue
+ * can not overflow. Should it still be full, a data update request is dropped
+ * and counted as an overflow, while the queue is extended for completion
+ * (read, write, connection loss) requests, which must never be dropped.
+ * The extension is limited to a fixed multiple of the attached records'
+ * requests; beyond that, completions fall back to the EPICS callback queues.
+ * The worker threads (all running at the same priority) take the requests
+ * in order of arrival and process the records, taking the record lock.
+ *
+ * With more than one worker thread, the requests for different records are
+ * processed concurrently.
+ */
+class ProcessingExecutor : public epicsThreadRunable
+{
+public:
+    /**
+     * @brief Constructor for ProcessingExecutor (starts the worker threads).
+     *
+     * @param name       name of the worker threads (suffixed with the thread number)
+     * @param threads    number of worker threads
+     * @param priority   EPICS priority of the worker threads
+     */
+    ProcessingExecutor(const std::string &name,
+                       const unsigned int threads,
+                       const unsigned int priority);
+
+    ~ProcessingExecutor() override;
+
+    /**
+     * @brief Attach a record (extends the queue by its max. number of requests).
+     */
+    void attach();
+
+    /**
+     * @brief Queue a processing request.
+     *
+     * @param pconnector  connector of the record to process
+     * @param reason      reason for processing
+     *
+     * @return false if the request was dropped (data update with queue full, executor stopped,
+     *         or completion fallback to a full callback queue)
+     */
+    bool request(RecordConnector *pconnector, const ProcessReason reason);
+
+    /**
+     * @brief Stop the worker threads (waits for the current requests to finish).
+     *
+     * Requests that are still in the queue are discarded.
+     */
+    void stop();
+
+    /**
+     * @brief Print configuration and statistics on stdout.
+     */
+    void show() const;
+
+    // epicsThreadRunable interface
+    virtual void run() override;
+
+private:
+    struct Request {
+        RecordConnector *pconnector;
+        ProcessReason reason;
+    };
+
+    void resize(const size_t size);
+    size_t maxQueueSize() const;
+
+    const std::string name;
+    const unsigned int priority;                         /**< priority of the worker threads */
+    size_t noOfRecords;                                  /**< number of attached records */
+    std::vector<Request> queue;                          /**< ring of queued requests */
+    size_t head;                                         /**< index of the oldest request */
+    size_t count;                                        /**< number of queued requests */
+    mutable epicsMutex lock;
+    epicsEvent workToDo;
+    std::vector<std::unique_ptr<epicsThread>> workers;
+    bool running;
+    size_t highWater;                                    /**< max. number of queued requests */
+    epicsUInt64 noOfRequests;                            /**< number of processed requests */
+    epicsUInt64 noOfOverflows;                           /**< number of dropped requests */
+    epicsUInt64 noOfExtensions;                          /**< number of queue extensions on overflow */
+    epicsUInt64 noOfFallbacks;                           /**< number of completions sent to the callback queues */
+};
+
+} // namespace DevOpcua
+
+#endif // DEVOPCUA_PROCESSINGEXECUTOR_H
@@ -18,6 +18,7 @@
 #include <link.h>
 #include <shareLib.h>
 #include <epicsThread.h>
+#include <epicsAtomic.h>
 #include <callback.h>
 #include <recSup.h>
 #include <recGbl.h>
@@ -31,6 +32,7 @@
 
 #define epicsExportSharedSymbols
 #include "RecordConnector.h"
+#include "ProcessingExecutor.h"
 #include "Session.h"
 
 namespace DevOpcua {
@@ -71,25 +73,19 @@ long reProcess (dbCommon *prec)
     return status;
 }
 
+static void processRecord (dbCommon *prec, const ProcessReason reason)
+{
+    if (!prec || !prec->dpvt) return;
+
+    static_cast<RecordConnector*>(prec->dpvt)->process(reason);
+}
+
 void processCallback (CALLBACK *pcallback, const ProcessReason reason)
 {
     void *pUsr;
-    dbCommon *prec;
 
     callbackGetUser(pUsr, pcallback);
-    prec = static_cast<dbCommon *>(pUsr);
-    if (!prec || !prec->dpvt) return;
-
-    RecordConnector *pvt = static_cast<RecordConnector*>(prec->dpvt);
-    dbScanLock(prec);
-    ProcessReason oldreason = pvt->reason;
-    pvt->reason = reason;
-    if (prec->pact)
-        reProcess(prec);
-    else
-        dbProcess(prec);
-    pvt->reason = oldreason;
-    dbScanUnlock(prec);
+    processRecord(static_cast<dbCommon *>(pUsr), reason);
 }
 
 void processIncomingDataCallback (CALLBACK *pcallback)
@@ -116,7 +112,10 @@ RecordConnector::RecordConnector (dbCommon *prec)
     : pitem(nullptr)
     , isIoIntrScanned(false)
     , reason(ProcessReason::none)
+    , executor(nullptr)
     , prec(prec)
+    , pending{0, 0, 0, 0}
+    , coalesced(0)
 {
     scanIoInit(&ioscanpvt);
     callbackSetCallback(DevOpcua::processIncomingDataCallback, &incomingDataCallback);
@@ -129,25 +128,83 @@ RecordConnector::RecordConnector (dbCommon *prec)
     callbackSetUser(prec, &connectionLossCallback);
 }
 
-void
+bool
 RecordConnector::requestRecordProcessing (const ProcessReason reason)
 {
-    if (isIoIntrScanned &&
-            (reason == ProcessReason::incomingData || reason == ProcessReason::connectionLoss)) {
+    ProcessingBatch::Collector *collector = nullptr;
+    if (!executor && isIoIntrScanned &&
+            (reason == ProcessReason::incomingData || reason == ProcessReason::connectionLoss)
+            && !(reason == ProcessReason::incomingData
+                 && (collector = ProcessingBatch::Collector::current()))) {
         this->reason = reason;
         scanIoRequest(ioscanpvt);
-    } else {
-        CALLBACK *callback = nullptr;
-        switch (reason) {
-        case ProcessReason::none :
-        case ProcessReason::incomingData : callback = &incomingDataCallback; break;
-        case ProcessReason::writeComplete : callback = &writeCompleteCallback; break;
-        case ProcessReason::readComplete : callback = &readCompleteCallback; break;
-        case ProcessReason::connectionLoss : callback = &connectionLossCallback; break;
+        return true;
+    }
+
+    // A processing for this reason is already queued: it will use the latest data
+    int &flag = pending[pendingIndex(reason)];
+    if (epics::atomic::compareAndSwap(flag, 0, 1) != 0) {
+        epics::atomic::increment(coalesced);
+        return true;
+    }
+
+    if (executor) {
+        if (!executor->request(this, reason)) {
+            epics::atomic::set(flag, 0);
+            if (debug())
+                errlogPrintf("%s: processing request dropped (executor queue full)\n",
+                             prec->name);
+            return false;
         }
-        callbackSetPriority(prec->prio, callback);
-        callbackRequest(callback);
+    } else if (collector) {
+        collector->add(this);
+    } else if (!requestCallback(reason)) {
+        epics::atomic::set(flag, 0);
+        if (debug())
+            errlogPrintf("%s: processing request dropped (callback queue full)\n",
+                         prec->name);
+        return false;
     }
+    return true;
+}
+
+bool
+RecordConnector::requestCallback (const ProcessReason reason)
+{
+    CALLBACK *callback = nullptr;
+    switch (reason) {
+    case ProcessReason::none :
+    case ProcessReason::incomingData : callback = &incomingDataCallback; break;
+    case ProcessReason::writeComplete : callback = &writeCompleteCallback; break;
+    case ProcessReason::readComplete : callback = &readCompleteCallback; break;
+    case ProcessReason::connectionLoss : callback = &connectionLossCallback; break;
+    }
+    callbackSetPriority(prec->prio, callback);
+    return callbackRequest(callback) == 0;
+}
+
+void
+RecordConnector::processingRequestFailed (const ProcessReason reason)
+{
+    epics::atomic::set(pending[pendingIndex(reason)], 0);
+    if (pdataelement)
+        pdataelement->processingRequestFailed(reason);
+}
+
+void
+RecordConnector::process (const ProcessReason reason)
+{
+    // Requests arriving from now on need another processing
+    epics::atomic::set(pending[pendingIndex(reason)], 0);
+    dbScanLock(prec);
+    ProcessReason oldreason = this->reason;
+    this->reason = reason;
+    if (prec->pact)
+        reProcess(prec);
+    else
+        dbProcess(prec);
+    this->reason = oldreason;
+    dbScanUnlock(prec);
 }
 
 void
@@ -184,4 +241,110 @@ RecordConnector::findRecordConnector (const std::string &name)
     return static_cast<RecordConnector *>(static_cast<dbCommon *>(entry.precnode->precord)->dpvt);
 }
 
+static epicsThreadPrivate<ProcessingBatch::Collector> currentCollector;
+
+ProcessingBatch::Collector::Collector (ProcessingBatch *batch)
+    : batch(batch)
+    , previous(nullptr)
+{
+    if (batch) {
+        previous = currentCollector.get();
+        currentCollector.set(this);
+    }
+}
+
+ProcessingBatch::Collector::~Collector ()
+{
+    if (batch) {
+        currentCollector.set(previous);
+        for (int i = 0; i < NUM_CALLBACK_PRIORITIES; i++)
+            if (records[i].size())
+                batch->submit(records[i], i);
+    }
+}
+
+ProcessingBatch::Collector *
+ProcessingBatch::Collector::current ()
+{
+    return currentCollector.get();
+}
+
+void
+ProcessingBatch::Collector::add (RecordConnector *pconnector)
+{
+    unsigned int priority = pconnector->prec->prio;
+    if (priority >= NUM_CALLBACK_PRIORITIES)
+        priority = NUM_CALLBACK_PRIORITIES - 1;
+    records[priority].push_back(pconnector);
+}
+
+ProcessingBatch::ProcessingBatch ()
+    : requests(0)
+    , callbacks(0)
+    , failures(0)
+{
+    for (int i = 0; i < NUM_CALLBACK_PRIORITIES; i++) {
+        queues[i].pending = false;
+        callbackSetCallback(ProcessingBatch::process, &queues[i].callback);
+        callbackSetUser(&queues[i], &queues[i].callback);
+        callbackSetPriority(i, &queues[i].callback);
+    }
+}
+
+void
+ProcessingBatch::submit (std::vector<RecordConnector *> &records, const int priority)
+{
+    Queue &q = queues[priority];
+    bool request = false;
+    {
+        Guard G(q.lock);
+        q.records.insert(q.records.end(), records.begin(), records.end());
+        if (!q.pending)
+            q.pending = request = true;
+    }
+    epics::atomic::add(requests, records.size());
+    if (!request)
+        return;
+    if (!callbackRequest(&q.callback)) {
+        epics::atomic::increment(callbacks);
+        return;
+    }
+
+    // Callback queue full: hand the records back, their next update requests processing again
+    std::vector<RecordConnector *> rejected;
+    {
+        Guard G(q.lock);
+        rejected.swap(q.records);
+        q.pending = false;
+    }
+    epics::atomic::increment(failures);
+    for (auto pconnector : rejected)
+        pconnector->processingRequestFailed(ProcessReason::incomingData);
+}
+
+void
+ProcessingBatch::process (CALLBACK *pcallback)
+{
+    void *pUsr;
+    std::vector<RecordConnector *> records;
+
+    callbackGetUser(pUsr, pcallback);
+    Queue &q = *static_cast<Queue *>(pUsr);
+    {
+        Guard G(q.lock);
+        records.swap(q.records);
+        q.pending = false;
+    }
+    for (auto pconnector : records)
+        processRecord(pconnector->prec, ProcessReason::incomingData);
+}
+
+void
+ProcessingBatch::show () const
+{
+    std::cout << " batched(requests/callbacks)=" << epics::atomic::get(requests)
+              << "/" << epics::atomic::get(callbacks)
+              << "(" << epics::atomic::get(failures) << " failed)";
+}
+
 } // namespace DevOpcua
@@ -16,8 +16,10 @@
 
 #include <memory>
 #include <cstddef>
+#include <vector>
 
 #include <epicsMutex.h>
+#include <epicsAtomic.h>
 #include <dbCommon.h>
 #include <dbScan.h>
 #include <callback.h>
@@ -28,8 +30,13 @@
 
 namespace DevOpcua {
 
+class ProcessingBatch;
+class ProcessingExecutor;
+
 class RecordConnector
 {
+    friend class ProcessingBatch;
+
 public:
     RecordConnector(dbCommon *prec);
 
@@ -75,7 +82,52 @@ public:
     void setDataElement(std::shared_ptr<DataElement> data) { pdataelement = data; }
     void clearDataElement() { pdataelement = nullptr; }
 
-    void requestRecordProcessing(const ProcessReason reason);
+    /**
+     * @brief Request processing of the record.
+     *
+     * @param reason  reason for processing
+     *
+     * @return false if the request was rejected (queue full)
+     */
+    bool requestRecordProcessing(const ProcessReason reason);
+
+    /**
+     * @brief Queue processing of the record on the EPICS callback queues.
+     *
+     * Used directly if the record has no executor, and by the executor
+     * for completions that do not fit into its queue.
+     *
+     * @param reason  reason for processing
+     *
+     * @return false if the request was rejected (callback queue full)
+     */
+    bool requestCallback(const ProcessReason reason);
+
+    /**
+     * @brief Process the record in the calling thread (takes the record lock).
+     *
+     * @param reason  reason for processing
+     */
+    void process(const ProcessReason reason);
+
+    /**
+     * @brief Get the number of processing requests that were merged into a pending one.
+     */
+    size_t noOfCoalesced() const { return epics::atomic::get(coalesced); }
+
+    /**
+     * @brief Get the index of the pending flag for a processing reason.
+     */
+    static unsigned int pendingIndex(const ProcessReason reason)
+    {
+        switch (reason) {
+        case ProcessReason::readComplete : return 1;
+        case ProcessReason::writeComplete : return 2;
+        case ProcessReason::connectionLoss : return 3;
+        default : return 0;
+        }
+    }
+
     void requestOpcuaRead() { pitem->requestRead(); }
     void requestOpcuaWrite() { pitem->requestWrite(); }
 
@@ -98,12 +150,92 @@ public:
     bool isIoIntrScanned;
     IOSCANPVT ioscanpvt;
     ProcessReason reason;
+    ProcessingExecutor *executor;    /**< session executor (nullptr = EPICS callback queues) */
 private:
+    /**
+     * @brief Undo the bookkeeping of a request that was accepted, but could not be queued later.
+     */
+    void processingRequestFailed(const ProcessReason reason);
+
     dbCommon *prec;
     CALLBACK incomingDataCallback;
     CALLBACK readCompleteCallback;
     CALLBACK writeCompleteCallback;
     CALLBACK connectionLossCallback;
+    int pending[4];                  /**< processing is queued (per callback) */
+    size_t coalesced;                /**< number of requests merged into a pending one */
+};
+
+/**
+ * @brief Batched processing of I/O Intr scanned records.
+ *
+ * While a Collector is in scope, the incoming data processing requests
+ * of I/O Intr scanned records that are made by the same thread are
+ * collected (instead of calling scanIoRequest for each record).
+ * When the Collector goes out of scope, the collected records are queued
+ * with one lock operation per priority, and one callback request per
+ * priority processes all of them.
+ *
+ * A batch is used by one data source (e.g. a subscription); the
+ * callbacks of different batches are independent.
+ */
+class ProcessingBatch
+{
+public:
+    /**
+     * @brief Collects processing requests of the current thread into a batch.
+     */
+    class Collector
+    {
+    public:
+        /**
+         * @brief Start collecting.
+         *
+         * @param batch  batch to submit to (nullptr = do not collect)
+         */
+        Collector(ProcessingBatch *batch);
+
+        /**
+         * @brief Stop collecting, submit the collected requests to the batch.
+         */
+        ~Collector();
+
+        /**
+         * @brief Get the collector of the current thread.
+         * @return collector, nullptr if the thread does not collect
+         */
+        static Collector *current();
+
+        void add(RecordConnector *pconnector);
+
+    private:
+        ProcessingBatch *batch;
+        Collector *previous;                                      /**< outer collector of the thread */
+        std::vector<RecordConnector *> records[NUM_CALLBACK_PRIORITIES];
+    };
+
+    ProcessingBatch();
+
+    /**
+     * @brief Print statistics on stdout.
+     */
+    void show() const;
+
+private:
+    struct Queue {
+        epicsMutex lock;
+        CALLBACK callback;
+        std::vector<RecordConnector *> records;  /**< records waiting for the callback */
+        bool pending;                            /**< callback has been requested */
+    };
+
+    void submit(std::vector<RecordConnector *> &records, const int priority);
+    static void process(CALLBACK *pcallback);
+
+    Queue queues[NUM_CALLBACK_PRIORITIES];
+    size_t requests;                             /**< number of batched processing requests */
+    size_t callbacks;                            /**< number of callback requests */
+    size_t failures;                             /**< number of rejected callback requests */
 };
 
 } // namespace DevOpcua
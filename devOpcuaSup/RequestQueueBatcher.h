@@ -0,0 +1,224 @@
+/*************************************************************************\
+* Copyright (c) 2026 ITER Organization.
+* This module is distributed subject to a Software License Agreement found
+* in file LICENSE that is included with this distribution.
+\*************************************************************************/
+
+/*
+ *  Author: agent <agent@local>
+ */
+
+#ifndef DEVOPCUA_REQUESTQUEUEBATCHER_H
+#define DEVOPCUA_REQUESTQUEUEBATCHER_H
+
+#include <string>
+#include <queue>
+#include <vector>
+#include <memory>
+
+#include <epicsTypes.h>
+#include <epicsMutex.h>
+#include <epicsGuard.h>
+#include <epicsEvent.h>
+#include <epicsThread.h>
+
+namespace DevOpcua {
+
+/**
+ * @brief Interface for the consumer of a RequestQueueBatcher.
+ *
+ * The consumer's processRequests method is called from the batcher's
+ * worker thread with a batch of requests taken from the queue.
+ */
+template<typename T>
+class RequestConsumer
+{
+public:
+    virtual ~RequestConsumer() {}
+
+    /**
+     * @brief Process a batch of requests.
+     *
+     * Called from the worker thread of the RequestQueueBatcher.
+     *
+     * @param batch  requests to process (in order of arrival)
+     */
+    virtual void processRequests(std::vector<std::shared_ptr<T>> &batch) = 0;
+};
+
+/**
+ * @brief A request queue with a worker thread that drains it in batches.
+ *
+ * Requests (of cargo type T) are pushed by any thread. The worker thread
+ * wakes up, takes as many requests as allowed for a single batch
+ * (maxRequestsPerBatch, 0 = no limit) and hands them to the consumer.
+ * This is repeated until the queue is empty.
+ */
+template<typename T>
+class RequestQueueBatcher : public epicsThreadRunable
+{
+public:
+    /**
+     * @brief Constructor for RequestQueueBatcher.
+     *
+     * @param name                 name of the worker thread
+     * @param consumer             consumer for the batches
+     * @param maxRequestsPerBatch  max. number of requests in one batch (0 = no limit)
+     * @param autoStart            start the worker thread immediately
+     */
+    RequestQueueBatcher(const std::string &name,
+                        RequestConsumer<T> &consumer,
+                        const unsigned int maxRequestsPerBatch = 0,
+                        const bool autoStart = true)
+        : name(name)
+        , consumer(consumer)
+        , maxRequestsPerBatch(maxRequestsPerBatch)
+        , worker(*this, this->name.c_str(),
+                 epicsThreadGetStackSize(epicsThreadStackSmall),
+                 epicsThreadPriorityMedium)
+        , running(false)
+        , noOfBatches(0)
+        , noOfRequests(0)
+    {
+        if (autoStart)
+            start();
+    }
+
+    ~RequestQueueBatcher() override { stop(); }
+
+    /**
+     * @brief Push a request into the queue.
+     *
+     * @param cargo  request to push
+     */
+    void pushRequest(std::shared_ptr<T> cargo)
+    {
+        {
+            Guard G(lock);
+            queue.push(cargo);
+        }
+        workToDo.signal();
+    }
+
+    /**
+     * @brief Get the number of requests in the queue.
+     */
+    size_t size() const
+    {
+        Guard G(lock);
+        return queue.size();
+    }
+
+    /**
+     * @brief Set the max. number of requests per batch (0 = no limit).
+     */
+    void setMaxRequestsPerBatch(const unsigned int max)
+    {
+        Guard G(lock);
+        maxRequestsPerBatch = max;
+    }
+
+    /**
+     * @brief Get the max. number of requests per batch (0 = no limit).
+     */
+    unsigned int maxRequests() const
+    {
+        Guard G(lock);
+        return maxRequestsPerBatch;
+    }
+
+    /**
+     * @brief Get the number of batches sent to the consumer.
+     */
+    epicsUInt64 batches() const
+    {
+        Guard G(lock);
+        return noOfBatches;
+    }
+
+    /**
+     * @brief Get the number of requests sent to the consumer.
+     */
+    epicsUInt64 requests() const
+    {
+        Guard G(lock);
+        return noOfRequests;
+    }
+
+    /**
+     * @brief Start the worker thread.
+     */
+    void start()
+    {
+        Guard G(lock);
+        if (!running) {
+            running = true;
+            worker.start();
+        }
+    }
+
+    /**
+     * @brief Stop the worker thread (waits for the current batch to finish).
+     *
+     * Requests that are still in the queue are discarded.
+     */
+    void stop()
+    {
+        {
+            Guard G(lock);
+            if (!running)
+                return;
+            running = false;
+        }
+        workToDo.signal();
+        worker.exitWait();
+    }
+
+    // epicsThreadRunable interface
+    virtual void run() override
+    {
+        std::vector<std::shared_ptr<T>> batch;
+
+        while (true) {
+            workToDo.wait();
+            while (true) {
+                {
+                    Guard G(lock);
+                    if (!running) {
+                        queue = std::queue<std::shared_ptr<T>>();
+                        return;
+                    }
+                    while (!queue.empty()
+                           && (!maxRequestsPerBatch || batch.size() < maxRequestsPerBatch)) {
+                        batch.push_back(queue.front());
+                        queue.pop();
+                    }
+                    if (batch.empty())
+                        break;
+                    noOfBatches++;
+                    noOfRequests += batch.size();
+                }
+                consumer.processRequests(batch);
+                batch.clear();
+            }
+        }
+    }
+
+private:
+    typedef epicsGuard<epicsMutex> Guard;
+
+    const std::string name;
+    RequestConsumer<T> &consumer;
+    std::queue<std::shared_ptr<T>> queue;
+    unsigned int maxRequestsPerBatch;
+    mutable epicsMutex lock;
+    epicsEvent workToDo;
+    epicsThread worker;
+    bool running;
+    epicsUInt64 noOfBatches;
+    epicsUInt64 noOfRequests;
+};
+
+} // namespace DevOpcua
+
+#endif // DEVOPCUA_REQUESTQUEUEBATCHER_H
@@ -0,0 +1,187 @@
+/*************************************************************************\
+* Copyright (c) 2026 ITER Organization.
+* This module is distributed subject to a Software License Agreement found
+* in file LICENSE that is included with this distribution.
+\*************************************************************************/
+
+/*
+ *  Author: agent <agent@local>
+ */
+
+#ifndef DEVOPCUA_RINGBUFFER_H
+#define DEVOPCUA_RINGBUFFER_H
+
+#include <vector>
+
+#include <epicsAtomic.h>
+
+namespace DevOpcua {
+
+/**
+ * @brief Bounded lock-free ring buffer for handing values from a writer to a reader.
+ *
+ * The writer claims a slot, fills it and publishes it. The reader takes the
+ * oldest value, reads it in place and pops it when done. Values are delivered
+ * in order, each exactly once.
+ *
+ * When the ring is full, the writer either drops the oldest unread value
+ * (discard oldest) or the new value (discard newest). If the oldest value is
+ * being read at that moment, the new value is dropped. Every dropped value
+ * is counted as an overflow.
+ *
+ * There must be only one writer and one reader at a time
+ * (concurrent writers must be serialized by the caller).
+ */
+template<typename T>
+class RingBuffer
+{
+public:
+    /**
+     * @brief Constructor.
+     *
+     * @param size           number of values (rounded up to a power of two)
+     * @param discardOldest  on overflow, drop the oldest value (instead of the new one)
+     */
+    explicit RingBuffer(const unsigned int size, const bool discardOldest = true)
+        : slots(roundUp(size))
+        , mask(2 * static_cast<int>(slots.size()) - 1)
+        , dropOldest(discardOldest)
+        , head(0)
+        , tail(0)
+        , published(0)
+        , overflows(0)
+    {}
+
+    /**
+     * @brief Claim the slot for the next value (writer side).
+     *
+     * @return slot to fill, nullptr if the new value has to be dropped
+     */
+    T *claim()
+    {
+        int h = epics::atomic::get(head);
+        Slot &slot = slots[tail & slotMask()];
+        if (distance(h, tail) == capacity()) {
+            // The tail slot is the oldest value's slot
+            if (dropOldest
+                    && epics::atomic::compareAndSwap(slot.state, full, writing) == full) {
+                epics::atomic::set(head, (h + 1) & mask);
+                epics::atomic::increment(overflows);
+                return &slot.value;
+            }
+            // Still full unless the reader has popped the oldest value in the meantime
+            if (epics::atomic::get(head) == h) {
+                epics::atomic::increment(overflows);
+                return nullptr;
+            }
+        }
+        epics::atomic::set(slot.state, writing);
+        return &slot.value;
+    }
+
+    /**
+     * @brief Publish the claimed slot (writer side).
+     */
+    void publish()
+    {
+        Slot &slot = slots[tail & slotMask()];
+        epics::atomic::compareAndSwap(slot.state, writing, full);
+        tail = (tail + 1) & mask;
+        epicsAtomicWriteMemoryBarrier();
+        epics::atomic::set(published, tail);
+    }
+
+    /**
+     * @brief Get the oldest value (reader side).
+     *
+     * The value stays in the ring (and can not be dropped) until pop() is called.
+     *
+     * @return oldest value, nullptr if the ring is empty
+     */
+    T *front()
+    {
+        int h;
+        while ((h = epics::atomic::get(head)) != epics::atomic::get(published)) {
+            Slot &slot = slots[h & slotMask()];
+            if (epics::atomic::compareAndSwap(slot.state, full, reading) == full) {
+                if (epics::atomic::get(head) == h)
+                    return &slot.value;
+                // The slot was dropped and refilled in between - give it back
+                epics::atomic::compareAndSwap(slot.state, reading, full);
+            }
+            // The writer is dropping that value - retry with the next one
+        }
+        return nullptr;
+    }
+
+    /**
+     * @brief Remove the value returned by front() (reader side).
+     */
+    void pop()
+    {
+        int h = epics::atomic::get(head);
+        Slot &slot = slots[h & slotMask()];
+        if (epics::atomic::get(slot.state) != reading)
+            return;
+        // Advance head first: a writer seeing the old head would find the
+        // ring full and the slot still being read, and drop its new value
+        epics::atomic::set(head, (h + 1) & mask);
+        epics::atomic::compareAndSwap(slot.state, reading, empty);
+    }
+
+    /**
+     * @brief Return true if no values are waiting to be read.
+     */
+    bool isEmpty() const { return epics::atomic::get(head) == epics::atomic::get(published); }
+
+    /**
+     * @brief Get the number of values in the ring.
+     */
+    int size() const { return distance(epics::atomic::get(head), epics::atomic::get(published)); }
+
+    /**
+     * @brief Get the maximal number of values in the ring.
+     */
+    int capacity() const { return static_cast<int>(slots.size()); }
+
+    /**
+     * @brief Get the number of dropped values.
+     */
+    int noOfOverflows() const { return epics::atomic::get(overflows); }
+
+    /**
+     * @brief Return true if the oldest value is dropped on overflow.
+     */
+    bool discardsOldest() const { return dropOldest; }
+
+private:
+    enum SlotState { empty, writing, full, reading };
+
+    struct Slot {
+        T value;
+        int state = empty;
+    };
+
+    static size_t roundUp(const unsigned int size)
+    {
+        size_t n = 1;
+        while (n < size)
+            n <<= 1;
+        return n;
+    }
+
+    int slotMask() const { return capacity() - 1; }
+    int distance(const int from, const int to) const { return (to - from) & mask; }
+
+    std::vector<Slot> slots;
+    const int mask;                  /**< indices run modulo twice the capacity */
+    const bool dropOldest;
+    int head;                        /**< index of the oldest value */
+    int tail;                        /**< index of the next slot to write (writer only) */
+    int published;                   /**< tail as seen by the reader */
+    int overflows;                   /**< number of dropped values */
+};
+
+} // namespace DevOpcua
+
+#endif // DEVOPCUA_RINGBUFFER_H
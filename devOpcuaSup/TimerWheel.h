@@ -0,0 +1,234 @@
+/*************************************************************************\
+* Copyright (c) 2026 ITER Organization.
+* This module is distributed subject to a Software License Agreement found
+* in file LICENSE that is included with this distribution.
+\*************************************************************************/
+
+/*
+ *  Author: agent <agent@local>
+ */
+
+#ifndef DEVOPCUA_TIMERWHEEL_H
+#define DEVOPCUA_TIMERWHEEL_H
+
+#include <string>
+#include <vector>
+
+#include <epicsTypes.h>
+#include <epicsTime.h>
+#include <epicsMutex.h>
+#include <epicsGuard.h>
+#include <epicsEvent.h>
+#include <epicsThread.h>
+
+namespace DevOpcua {
+
+/**
+ * @brief Interface for the consumer of a TimerWheel.
+ *
+ * The consumer's timersExpired method is called from the wheel's
+ * housekeeping thread with all timers that expired during a tick.
+ */
+template<typename T>
+class TimerConsumer
+{
+public:
+    virtual ~TimerConsumer() {}
+
+    /**
+     * @brief Handle expired timers.
+     *
+     * Called from the housekeeping thread of the TimerWheel.
+     *
+     * @param expired  cargo of the expired timers
+     */
+    virtual void timersExpired(std::vector<T> &expired) = 0;
+};
+
+/**
+ * @brief A hierarchical timer wheel with a housekeeping thread.
+ *
+ * Timers (with cargo of type T) are added by any thread. Adding a timer
+ * is O(1). The housekeeping thread advances the wheel once per tick and
+ * hands the cargo of all expired timers to the consumer.
+ *
+ * The wheel has three levels of 64 buckets each, covering 64^3 ticks
+ * (approx. 7 hours at the default tick of 0.1 s). Longer delays are clamped.
+ *
+ * Timers cannot be cancelled: the consumer is expected to use the cargo
+ * to check if the timed operation is still pending (lazy cancellation).
+ */
+template<typename T>
+class TimerWheel : public epicsThreadRunable
+{
+public:
+    /**
+     * @brief Constructor for TimerWheel.
+     *
+     * @param name       name of the housekeeping thread
+     * @param consumer   consumer for the expired timers
+     * @param tick       tick (resolution) of the wheel [s]
+     * @param autoStart  start the housekeeping thread immediately
+     */
+    TimerWheel(const std::string &name,
+               TimerConsumer<T> &consumer,
+               const double tick = 0.1,
+               const bool autoStart = true)
+        : name(name)
+        , consumer(consumer)
+        , tick(tick)
+        , start(epicsTime::getCurrent())
+        , current(0)
+        , noOfTimers(0)
+        , worker(*this, this->name.c_str(),
+                 epicsThreadGetStackSize(epicsThreadStackSmall),
+                 epicsThreadPriorityMedium)
+        , running(false)
+    {
+        if (autoStart)
+            startWorker();
+    }
+
+    ~TimerWheel() override { stop(); }
+
+    /**
+     * @brief Add a timer.
+     *
+     * @param delay  delay until expiry [s]
+     * @param cargo  cargo to hand to the consumer on expiry
+     */
+    void add(const double delay, const T &cargo)
+    {
+        epicsUInt64 ticks = (delay > 0.0) ? static_cast<epicsUInt64>(delay / tick + 0.5) : 0;
+        Guard G(lock);
+        insert(Timer{cargo, current + (ticks ? ticks : 1)});
+        noOfTimers++;
+    }
+
+    /**
+     * @brief Get the number of timers in the wheel (including lazily cancelled ones).
+     */
+    size_t size() const
+    {
+        Guard G(lock);
+        return noOfTimers;
+    }
+
+    /**
+     * @brief Start the housekeeping thread.
+     */
+    void startWorker()
+    {
+        Guard G(lock);
+        if (!running) {
+            running = true;
+            worker.start();
+        }
+    }
+
+    /**
+     * @brief Stop the housekeeping thread.
+     *
+     * Timers that are still in the wheel are discarded.
+     */
+    void stop()
+    {
+        {
+            Guard G(lock);
+            if (!running)
+                return;
+            running = false;
+        }
+        wakeup.signal();
+        worker.exitWait();
+    }
+
+    // epicsThreadRunable interface
+    virtual void run() override
+    {
+        std::vector<T> expired;
+
+        while (true) {
+            wakeup.wait(tick);
+            {
+                Guard G(lock);
+                if (!running) {
+                    for (auto &level : wheel)
+                        for (auto &bucket : level)
+                            bucket.clear();
+                    noOfTimers = 0;
+                    return;
+                }
+                epicsUInt64 now = static_cast<epicsUInt64>((epicsTime::getCurrent() - start) / tick);
+                while (current < now)
+                    advance(expired);
+            }
+            if (expired.size()) {
+                consumer.timersExpired(expired);
+                expired.clear();
+            }
+        }
+    }
+
+private:
+    typedef epicsGuard<epicsMutex> Guard;
+
+    static const unsigned int levels = 3;
+    static const unsigned int bits = 6;
+    static const epicsUInt64 buckets = 1 << bits;
+    static const epicsUInt64 bucketMask = buckets - 1;
+
+    struct Timer {
+        T cargo;
+        epicsUInt64 expires;    /**< expiry time [ticks] */
+    };
+
+    // Put a timer into the bucket that matches its distance from now (lock must be held)
+    void insert(const Timer &timer)
+    {
+        epicsUInt64 expires = timer.expires;
+        epicsUInt64 delta = expires - current;
+        unsigned int level = 0;
+        while (level < levels - 1 && delta >= (buckets << (level * bits)))
+            level++;
+        if (delta >= (buckets << (level * bits)))
+            expires = current + (buckets << (level * bits)) - 1;
+        wheel[level][(expires >> (level * bits)) & bucketMask].push_back(Timer{timer.cargo, expires});
+    }
+
+    // Advance the wheel by one tick, collecting expired timers (lock must be held)
+    void advance(std::vector<T> &expired)
+    {
+        current++;
+        // cascade timers from the higher levels when the lower level wraps
+        for (unsigned int level = 1; level < levels; level++) {
+            if (current & ((1ULL << (level * bits)) - 1))
+                break;
+            std::vector<Timer> cascading;
+            cascading.swap(wheel[level][(current >> (level * bits)) & bucketMask]);
+            for (auto &timer : cascading)
+                insert(timer);
+        }
+        std::vector<Timer> &bucket = wheel[0][current & bucketMask];
+        for (auto &timer : bucket)
+            expired.push_back(timer.cargo);
+        noOfTimers -= bucket.size();
+        bucket.clear();
+    }
+
+    const std::string name;
+    TimerConsumer<T> &consumer;
+    const double tick;                                  /**< tick of the wheel [s] */
+    const epicsTime start;                              /**< time of tick 0 */
+    epicsUInt64 current;                                /**< current time [ticks] */
+    std::vector<Timer> wheel[levels][buckets];          /**< timer buckets */
+    size_t noOfTimers;
+    mutable epicsMutex lock;
+    epicsEvent wakeup;
+    epicsThread worker;
+    bool running;
+};
+
+} // namespace DevOpcua
+
+#endif // DEVOPCUA_TIMERWHEEL_H
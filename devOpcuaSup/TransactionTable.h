@@ -0,0 +1,198 @@
+/*************************************************************************\
+* Copyright (c) 2026 ITER Organization.
+* This module is distributed subject to a Software License Agreement found
+* in file LICENSE that is included with this distribution.
+\*************************************************************************/
+
+/*
+ *  Author: agent <agent@local>
+ */
+
+#ifndef DEVOPCUA_TRANSACTIONTABLE_H
+#define DEVOPCUA_TRANSACTIONTABLE_H
+
+#include <vector>
+#include <memory>
+
+#include <epicsTypes.h>
+#include <epicsAtomic.h>
+#include <epicsThread.h>
+
+namespace DevOpcua {
+
+/**
+ * @brief Fixed-capacity, lock-free table of outstanding transactions.
+ *
+ * Every outstanding (asynchronous) service call is kept in a slot of the table,
+ * indexed by its transaction id (modulo capacity). A slot holds the list of
+ * items (of type T) that the service call was issued for.
+ *
+ * The item lists are owned by the slots and recycled, i.e. after the first
+ * few service calls, no heap allocations are needed for tracking.
+ *
+ * Slots go through the states free -> reserved -> active -> completing -> free.
+ * All state transitions are done through atomic compare-and-swap,
+ * so that the requesting threads and the client library's callback threads
+ * do not need a common lock.
+ *
+ * Reserving a slot fails if the slot for the transaction id is in use.
+ * The caller then retries with the next transaction id or applies its
+ * overflow policy.
+ *
+ * Claiming a transaction that has already been completed (or whose slot
+ * has been reused) fails, i.e. stale transaction ids (e.g. from expired
+ * timers) are safely ignored.
+ */
+template<typename T>
+class TransactionTable
+{
+public:
+    /**
+     * @brief Constructor for TransactionTable.
+     *
+     * @param capacity  number of slots (rounded up to a power of two)
+     */
+    explicit TransactionTable(const epicsUInt32 capacity = 1024)
+        : mask(roundUp(capacity) - 1)
+        , slots(new Slot[mask + 1])
+        , active(0)
+    {}
+
+    /**
+     * @brief Get the number of slots in the table.
+     */
+    epicsUInt32 capacity() const { return mask + 1; }
+
+    /**
+     * @brief Get the number of transactions currently in flight.
+     */
+    int inFlight() const { return epics::atomic::get(active); }
+
+    /**
+     * @brief Reserve the slot for a transaction.
+     *
+     * @param id  transaction id
+     * @return pointer to the (empty) item list of the slot, nullptr if the slot is in use
+     */
+    std::vector<T *> *reserve(const epicsUInt32 id)
+    {
+        Slot &slot = slots[id & mask];
+        if (epics::atomic::compareAndSwap(slot.state, slotFree, slotReserved) != slotFree)
+            return nullptr;
+        epics::atomic::set(slot.id, static_cast<size_t>(id));
+        slot.items.clear();
+        return &slot.items;
+    }
+
+    /**
+     * @brief Activate a reserved transaction (make it visible for completion).
+     *
+     * Must be called before the service call is issued.
+     *
+     * @param id   transaction id
+     * @param tag  user defined tag (to find the active transactions of a kind)
+     */
+    void activate(const epicsUInt32 id, const epicsUInt32 tag = 0)
+    {
+        Slot &slot = slots[id & mask];
+        slot.tag = tag;
+        epics::atomic::increment(active);
+        epicsAtomicWriteMemoryBarrier();
+        epics::atomic::set(slot.state, static_cast<int>(slotActive));
+    }
+
+    /**
+     * @brief Claim an active transaction for completion.
+     *
+     * Only one thread can successfully claim a transaction.
+     *
+     * @param id  transaction id
+     * @return pointer to the item list of the transaction, nullptr if there is no such active transaction
+     */
+    std::vector<T *> *claim(const epicsUInt32 id)
+    {
+        Slot &slot = slots[id & mask];
+        while (true) {
+            if (epics::atomic::get(slot.id) != id)
+                return nullptr;
+            int prev = epics::atomic::compareAndSwap(slot.state, slotActive, slotCompleting);
+            if (prev == slotActive) {
+                if (epics::atomic::get(slot.id) == id) {
+                    epicsAtomicReadMemoryBarrier();
+                    return &slot.items;
+                }
+                // slot has been reused by a different transaction
+                epics::atomic::set(slot.state, static_cast<int>(slotActive));
+                return nullptr;
+            }
+            if (prev != slotCompleting)
+                return nullptr;
+            // another thread holds the slot (possibly only transiently) - retry
+            epicsThreadSleep(0.0);
+        }
+    }
+
+    /**
+     * @brief Get the ids of the active transactions with a tag.
+     *
+     * The transactions may complete concurrently, i.e. claiming an id
+     * of the result can fail.
+     *
+     * @param tag  tag given on activation
+     * @param ids  [out] transaction ids
+     */
+    void activeIds(const epicsUInt32 tag, std::vector<epicsUInt32> &ids) const
+    {
+        ids.clear();
+        for (epicsUInt32 i = 0; i <= mask; i++) {
+            const Slot &slot = slots[i];
+            if (epics::atomic::get(slot.state) != slotActive)
+                continue;
+            epicsAtomicReadMemoryBarrier();
+            if (slot.tag == tag)
+                ids.push_back(static_cast<epicsUInt32>(epics::atomic::get(slot.id)));
+        }
+    }
+
+    /**
+     * @brief Release a claimed (or reserved) transaction, freeing its slot.
+     *
+     * @param id  transaction id
+     */
+    void release(const epicsUInt32 id)
+    {
+        Slot &slot = slots[id & mask];
+        if (epics::atomic::get(slot.state) == slotCompleting)
+            epics::atomic::decrement(active);
+        slot.items.clear();
+        epicsAtomicWriteMemoryBarrier();
+        epics::atomic::set(slot.state, static_cast<int>(slotFree));
+    }
+
+private:
+    enum SlotState { slotFree, slotReserved, slotActive, slotCompleting };
+
+    struct Slot {
+        Slot() : state(slotFree), id(0), tag(0) {}
+        int state;                  /**< slot state (SlotState) */
+        size_t id;                  /**< transaction id */
+        epicsUInt32 tag;            /**< user defined tag (set on activation) */
+        std::vector<T *> items;     /**< items of the transaction (recycled) */
+    };
+
+    static epicsUInt32 roundUp(epicsUInt32 n)
+    {
+        epicsUInt32 size = 1;
+        while (size < n)
+            size <<= 1;
+        return size;
+    }
+
+    const epicsUInt32 mask;
+    std::unique_ptr<Slot[]> slots;
+    int active;                     /**< number of transactions in flight */
+};
+
+} // namespace DevOpcua
+
+#endif // DEVOPCUA_TRANSACTIONTABLE_H
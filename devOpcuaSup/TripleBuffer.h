@@ -0,0 +1,104 @@
+/*************************************************************************\
+* Copyright (c) 2026 ITER Organization.
+* This module is distributed subject to a Software License Agreement found
+* in file LICENSE that is included with this distribution.
+\*************************************************************************/
+
+/*
+ *  Author: agent <agent@local>
+ */
+
+#ifndef DEVOPCUA_TRIPLEBUFFER_H
+#define DEVOPCUA_TRIPLEBUFFER_H
+
+#include <epicsAtomic.h>
+
+namespace DevOpcua {
+
+/**
+ * @brief Lock-free triple buffer for handing a value from a writer to a reader.
+ *
+ * The writer fills the back buffer and publishes it, the reader acquires the
+ * latest published buffer and reads it. Neither side ever blocks or waits:
+ * publishing and acquiring are single atomic exchanges of buffer indices.
+ *
+ * The reader always sees a consistent snapshot of the last value published
+ * before acquiring. Values that are published while the previous value has
+ * not been acquired yet are overwritten (publish reports that).
+ *
+ * There must be only one writer and one reader at a time
+ * (concurrent writers must be serialized by the caller).
+ */
+template<typename T>
+class TripleBuffer
+{
+public:
+    TripleBuffer()
+        : latest(1)
+        , back(0)
+        , front(2)
+    {}
+
+    /**
+     * @brief Get the back buffer (writer side).
+     */
+    T &writeBuffer() { return buffers[back]; }
+
+    /**
+     * @brief Publish the back buffer (writer side).
+     *
+     * @return true if an unconsumed value was overwritten
+     */
+    bool publish()
+    {
+        int prev = exchange(back | fresh);
+        back = prev & indexMask;
+        return (prev & fresh) != 0;
+    }
+
+    /**
+     * @brief Acquire the latest published buffer (reader side).
+     *
+     * @return true if a new value was acquired, false if the front buffer is unchanged
+     */
+    bool acquire()
+    {
+        if (!(epics::atomic::get(latest) & fresh))
+            return false;
+        front = exchange(front) & indexMask;
+        return true;
+    }
+
+    /**
+     * @brief Get the front buffer (reader side).
+     */
+    T &readBuffer() { return buffers[front]; }
+    const T &readBuffer() const { return buffers[front]; }
+
+    /**
+     * @brief Return true if a published value is waiting to be acquired.
+     */
+    bool hasNew() const { return (epics::atomic::get(latest) & fresh) != 0; }
+
+private:
+    static const int fresh = 4;      /**< flag: latest buffer has not been acquired */
+    static const int indexMask = 3;
+
+    int exchange(const int value)
+    {
+        int prev;
+        do {
+            prev = epics::atomic::get(latest);
+        } while (epics::atomic::compareAndSwap(latest, prev, value) != prev);
+        return prev;
+    }
+
+    T buffers[3];
+    int latest;                      /**< index of the latest published buffer | fresh */
+    int back;                        /**< index of the writer's buffer */
+    int front;                       /**< index of the reader's buffer */
+};
+
+} // namespace DevOpcua
+
+#endif // DEVOPCUA_TRIPLEBUFFER_H
@@ -0,0 +1,95 @@
+/*************************************************************************\
+* Copyright (c) 2026 ITER Organization.
+* This module is distributed subject to a Software License Agreement found
+* in file LICENSE that is included with this distribution.
+\*************************************************************************/
+
+/*
+ *  Author: agent <agent@local>
+ *
+ *  based on example code from the Unified Automation C++ Based OPC UA Client SDK
+ */
+
+#include <uaclientsdk.h>
+#include <uasession.h>
+
+#define epicsExportSharedSymbols
+#include "ChannelUaSdk.h"
+#include "SessionUaSdk.h"
+
+namespace DevOpcua {
+
+using namespace UaClientSdk;
+
+ChannelUaSdk::ChannelUaSdk (SessionUaSdk &session, const unsigned int index)
+    : session(session)
+    , index(index)
+    , puasession(new UaSession())
+    , serverConnectionStatus(UaClient::Disconnected)
+{}
+
+ChannelUaSdk::~ChannelUaSdk ()
+{
+    if (isConnected()) {
+        ServiceSettings serviceSettings;
+        puasession->disconnect(serviceSettings, OpcUa_True);
+    }
+    delete puasession;
+}
+
+UaStatus
+ChannelUaSdk::connect (const UaString &serverUrl,
+                       SessionConnectInfo &connectInfo,
+                       SessionSecurityInfo &securityInfo)
+{
+    return puasession->connect(serverUrl,      // URL of the Endpoint
+                               connectInfo,    // General connection settings
+                               securityInfo,   // Security settings
+                               this);          // Callback interface
+}
+
+UaStatus
+ChannelUaSdk::disconnect ()
+{
+    ServiceSettings serviceSettings;
+
+    return puasession->disconnect(serviceSettings,  // Use default settings
+                                  OpcUa_True);      // Delete subscriptions
+}
+
+bool
+ChannelUaSdk::isConnected () const
+{
+    return (!!puasession->isConnected()
+            && serverConnectionStatus != UaClient::ConnectionErrorApiReconnect);
+}
+
+// UaSessionCallback interface
+
+void
+ChannelUaSdk::connectionStatusChanged (OpcUa_UInt32 clientConnectionId,
+                                       UaClient::ServerStatus serverStatus)
+{
+    OpcUa_ReferenceParameter(clientConnectionId);
+    session.connectionStatusChanged(*this, serverStatus);
+}
+
+void
+ChannelUaSdk::readComplete (OpcUa_UInt32 transactionId,
+                            const UaStatus &result,
+                            const UaDataValues &values,
+                            const UaDiagnosticInfos &diagnosticInfos)
+{
+    session.readComplete(transactionId, result, values, diagnosticInfos);
+}
+
+void
+ChannelUaSdk::writeComplete (OpcUa_UInt32 transactionId,
+                             const UaStatus &result,
+                             const UaStatusCodeArray &results,
+                             const UaDiagnosticInfos &diagnosticInfos)
+{
+    session.writeComplete(transactionId, result, results, diagnosticInfos);
+}
+
+} // namespace DevOpcua
@@ -0,0 +1,121 @@
+/*************************************************************************\
+* Copyright (c) 2026 ITER Organization.
+* This module is distributed subject to a Software License Agreement found
+* in file LICENSE that is included with this distribution.
+\*************************************************************************/
+
+/*
+ *  Author: agent <agent@local>
+ *
+ *  based on example code from the Unified Automation C++ Based OPC UA Client SDK
+ */
+
+#ifndef DEVOPCUA_CHANNELUASDK_H
+#define DEVOPCUA_CHANNELUASDK_H
+
+#include <uabase.h>
+#include <uaclientsdk.h>
+#include <uasession.h>
+
+namespace DevOpcua {
+
+using namespace UaClientSdk;
+
+class SessionUaSdk;
+
+/**
+ * @brief One channel (low level client session) of a SessionUaSdk.
+ *
+ * A SessionUaSdk opens one or more channels to the same endpoint
+ * (channels option). Every channel has its own secure channel and
+ * client library callback thread.
+ *
+ * The channel is the callback interface of its low level session and
+ * forwards all callbacks to the SessionUaSdk, tagged with the channel.
+ */
+class ChannelUaSdk : public UaSessionCallback
+{
+    UA_DISABLE_COPY(ChannelUaSdk);
+
+public:
+    /**
+     * @brief Create a channel of an OPC UA session.
+     *
+     * @param session  session the channel belongs to
+     * @param index    index of the channel in the session
+     */
+    ChannelUaSdk(SessionUaSdk &session, const unsigned int index);
+    ~ChannelUaSdk() override;
+
+    /**
+     * @brief Connect the channel (asynchronously).
+     *
+     * @param serverUrl     URL of the endpoint
+     * @param connectInfo   general connection settings
+     * @param securityInfo  security settings
+     *
+     * @return status of the connect service
+     */
+    UaStatus connect(const UaString &serverUrl,
+                     SessionConnectInfo &connectInfo,
+                     SessionSecurityInfo &securityInfo);
+
+    /**
+     * @brief Disconnect the channel, deleting its subscriptions.
+     *
+     * @return status of the disconnect service
+     */
+    UaStatus disconnect();
+
+    /**
+     * @brief Return connection status of the channel.
+     */
+    bool isConnected() const;
+
+    /**
+     * @brief Get the index of the channel in its session.
+     */
+    unsigned int getIndex() const { return index; }
+
+    /**
+     * @brief Get the low level session of the channel.
+     */
+    UaSession *getUaSession() const { return puasession; }
+
+    /**
+     * @brief Get the server connection status of the channel.
+     */
+    UaClient::ServerStatus getServerStatus() const { return serverConnectionStatus; }
+
+    /**
+     * @brief Set the server connection status of the channel.
+     */
+    void setServerStatus(const UaClient::ServerStatus status) { serverConnectionStatus = status; }
+
+    // UaSessionCallback interface
+    virtual void connectionStatusChanged(
+            OpcUa_UInt32 clientConnectionId,
+            UaClient::ServerStatus serverStatus) override;
+
+    virtual void readComplete(
+            OpcUa_UInt32 transactionId,
+            const UaStatus &result,
+            const UaDataValues &values,
+            const UaDiagnosticInfos &diagnosticInfos) override;
+
+    virtual void writeComplete(
+            OpcUa_UInt32 transactionId,
+            const UaStatus &result,
+            const UaStatusCodeArray &results,
+            const UaDiagnosticInfos &diagnosticInfos) override;
+
+private:
+    SessionUaSdk &session;                                    /**< session the channel belongs to */
+    const unsigned int index;                                 /**< index of the channel in the session */
+    UaSession *puasession;                                    /**< pointer to low level session */
+    UaClient::ServerStatus serverConnectionStatus;            /**< connection status for this channel */
+};
+
+} // namespace DevOpcua
+
+#endif // DEVOPCUA_CHANNELUASDK_H
@@ -17,6 +17,7 @@
 #endif
 
 #include <iostream>
+#include <algorithm>
 #include <limits>
 #include <string>
 #include <cstring>
@@ -28,9 +29,11 @@
 #include <opcua_builtintypes.h>
 
 #include <errlog.h>
+#include <epicsTime.h>
 
 #include "ItemUaSdk.h"
 #include "DataElementUaSdk.h"
+#include "SessionUaSdk.h"
 #include "RecordConnector.h"
 
 namespace DevOpcua {
@@ -74,21 +77,110 @@ DataElementUaSdk::DataElementUaSdk (const std::string &name,
                                     RecordConnector *pconnector)
     : DataElement(pconnector, name)
     , pitem(item)
+    , firstChild(0)
+    , noOfChildren(0)
+    , arrayIndex(-1)
     , mapped(false)
+    , definitionGeneration(-1)
+    , decoderGeneration(-1)
     , incomingType(OpcUaType_Null)
     , incomingIsArray(false)
-{}
+    , queued(nullptr)
+    , processingRequested(0)
+    , snapshotTaken(false)
+    , overwritten(0)
+    , valueReady(0)
+{
+    parseArrayIndex();
+
+    epicsUInt32 queueSize = pconnector->plinkinfo->clientQueueSize;
+    if (!queueSize)
+        queueSize = item->linkinfo.queueSize;
+    if (queueSize > 1)
+        incomingQueue.reset(new RingBuffer<IncomingValue>(queueSize, item->linkinfo.discardOldest));
+
+    if (pconnector->plinkinfo->packSamples)
+        packer.reset(new SamplePackerUaSdk(pconnector->plinkinfo->packSamples,
+                                           pconnector->plinkinfo->packTimestamps));
+    if (pconnector->plinkinfo->aggregate.length())
+        aggregator.reset(new Aggregator(Aggregator::functionFromString(pconnector->plinkinfo->aggregate),
+                                        pconnector->plinkinfo->windowSamples));
+    if (pconnector->plinkinfo->dropDuplicates)
+        duplicateFilter.reset(new DuplicateFilter<UaVariant>(pconnector->plinkinfo->dropDuplicates > 1));
+}
 
 DataElementUaSdk::DataElementUaSdk (const std::string &name,
                                     ItemUaSdk *item,
                                     std::weak_ptr<DataElementUaSdk> child)
     : DataElement(name)
     , pitem(item)
+    , firstChild(0)
+    , noOfChildren(0)
+    , arrayIndex(-1)
     , mapped(false)
+    , definitionGeneration(-1)
+    , decoderGeneration(-1)
     , incomingType(OpcUaType_Null)
     , incomingIsArray(false)
+    , queued(nullptr)
+    , processingRequested(0)
+    , snapshotTaken(false)
+    , overwritten(0)
+    , valueReady(0)
 {
     elements.push_back(child);
+    parseArrayIndex();
+}
+
+void
+DataElementUaSdk::parseArrayIndex ()
+{
+    fieldName = name;
+    size_t open = name.find_last_of('[');
+    if (open != std::string::npos && open > 0 && name.back() == ']') {
+        const std::string index = name.substr(open + 1, name.length() - open - 2);
+        char *end;
+        unsigned long ul = std::strtoul(index.c_str(), &end, 10);
+        if (index.empty() || *end != '\0')
+            throw std::runtime_error(SB() << "invalid array index in element name " << name);
+        fieldName = name.substr(0, open);
+        arrayIndex = static_cast<int>(ul);
+    }
+}
+
+// Get one element of an array variant (false if not an array or index out of range)
+// The element is taken directly from the variant's array, without converting the array
+static bool
+arrayElement (const UaVariant &array, const int index, UaVariant &element)
+{
+    if (!array.isArray() || index < 0 || index >= array.arraySize())
+        return false;
+    const OpcUa_UInt32 i = static_cast<OpcUa_UInt32>(index);
+    const OpcUa_Variant *v = array;
+
+    switch (array.type()) {
+    case OpcUaType_ExtensionObject:
+    {
+        UaExtensionObject extensionObject(v->Value.Array.Value.ExtensionObjectArray[i]);
+        element.setExtensionObject(extensionObject, OpcUa_True);
+        break;
+    }
+    case OpcUaType_Boolean: element.setBoolean(v->Value.Array.Value.BooleanArray[i]); break;
+    case OpcUaType_SByte:   element.setSByte(v->Value.Array.Value.SByteArray[i]); break;
+    case OpcUaType_Byte:    element.setByte(v->Value.Array.Value.ByteArray[i]); break;
+    case OpcUaType_Int16:   element.setInt16(v->Value.Array.Value.Int16Array[i]); break;
+    case OpcUaType_UInt16:  element.setUInt16(v->Value.Array.Value.UInt16Array[i]); break;
+    case OpcUaType_Int32:   element.setInt32(v->Value.Array.Value.Int32Array[i]); break;
+    case OpcUaType_UInt32:  element.setUInt32(v->Value.Array.Value.UInt32Array[i]); break;
+    case OpcUaType_Int64:   element.setInt64(v->Value.Array.Value.Int64Array[i]); break;
+    case OpcUaType_UInt64:  element.setUInt64(v->Value.Array.Value.UInt64Array[i]); break;
+    case OpcUaType_Float:   element.setFloat(v->Value.Array.Value.FloatArray[i]); break;
+    case OpcUaType_Double:  element.setDouble(v->Value.Array.Value.DoubleArray[i]); break;
+    case OpcUaType_String:  element.setString(UaString(&v->Value.Array.Value.StringArray[i])); break;
+    default:
+        return false;
+    }
+    return true;
 }
 
 void
@@ -99,10 +191,33 @@ DataElementUaSdk::show (const int level, const unsigned int indent) const
     if (isLeaf()) {
         std::cout << "leaf=" << name << " record(" << pconnector->getRecordType() << ")="
                   << pconnector->getRecordName()
-                  << " type=" << variantTypeString(incomingType) << "\n";
+                  << " type=" << variantTypeString(incomingType);
+        if (incomingQueue)
+            std::cout << " queue=" << incomingQueue->size() << "/" << incomingQueue->capacity()
+                      << " discard=" << (incomingQueue->discardsOldest() ? "old" : "new")
+                      << " overflows=" << incomingQueue->noOfOverflows();
+        else
+            std::cout << " overwritten=" << epics::atomic::get(overwritten);
+        if (packer)
+            packer->show();
+        if (aggregator)
+            aggregator->show();
+        if (duplicateFilter)
+            std::cout << " duplicates=" << duplicateFilter->noOfDuplicates();
+        std::cout << " coalesced=" << pconnector->noOfCoalesced();
+        std::cout << "\n";
     } else {
         std::cout << "node=" << name << " children=" << elements.size()
-                  << " mapped=" << (mapped ? "y" : "n") << "\n";
+                  << " mapped=" << (mapped ? "y" : "n")
+                  << " decoder=";
+        if (decoder)
+            std::cout << "plan(" << decoder->noOfSteps() << " steps)";
+        else
+            std::cout << "generic";
+        std::cout << " decodes(plan/generic)=" << plannedStats.count << "/" << genericStats.count
+                  << " avg=" << plannedStats.average() << "/" << genericStats.average() << "us"
+                  << "(" << plannedStats.timed << "/" << genericStats.timed << " timed)"
+                  << "\n";
         for (auto it : elements) {
             if (auto pelem = it.lock()) {
                 pelem->show(level, indent + 1);
@@ -117,6 +232,8 @@ DataElementUaSdk::addElementChain (ItemUaSdk *item,
                                    const std::string &fullpath)
 {
     bool hasRootElement = true;
+    if (item->isFrozen())
+        throw std::runtime_error(SB() << "data element tree of item is frozen (after iocInit)");
     // Create final path element as leaf and link it to connector
     std::string path(fullpath);
     std::string restpath;
@@ -141,8 +258,15 @@ DataElementUaSdk::addElementChain (ItemUaSdk *item,
 
     // Simple case (leaf is the root element)
     if (leafname == "[ROOT]") {
-        if (hasRootElement) throw std::runtime_error(SB() << "root data element already set");
-        item->rootElement = chainelem;
+        if (hasRootElement) {
+            // Records sharing a scalar item each get their own root leaf
+            auto proot = topelem.lock();
+            if (!item->isShared() || !proot || !proot->isLeaf())
+                throw std::runtime_error(SB() << "root data element already set");
+            item->rootLeaves.push_back(chainelem);
+        } else {
+            item->rootElement = chainelem;
+        }
         return;
     }
 
@@ -223,7 +347,7 @@ DataElementUaSdk::addElementChain (ItemUaSdk *item,
 }
 
 void
-DataElementUaSdk::setIncomingData (const UaVariant &value)
+DataElementUaSdk::setIncomingData (const UaVariant &value, const ProcessReason reason)
 {
     incomingType = value.type();
     incomingIsArray = value.isArray();
@@ -232,19 +356,40 @@ DataElementUaSdk::setIncomingData (const UaVariant &value)
         if (debug() >= 5)
             std::cout << "Element " << name << " setting incoming data for record "
                       << pconnector->getRecordName() << std::endl;
-        Guard(pconnector->lock);
-        incomingData = value;
+        if (duplicateFilter && isDuplicate(value, reason))
+            return;
+        // A read completes with the partial block/window (the record is waiting)
+        if (packer) {
+            packSample(value);
+            if (reason == ProcessReason::readComplete && !packer->isEmpty())
+                deliverBlock(reason);
+        } else if (aggregator) {
+            aggregateSample(value);
+            if (reason == ProcessReason::readComplete && !aggregator->isEmpty())
+                deliverWindow(reason);
+        } else {
+            handOff(value, pitem->tsSource, pitem->tsServer, reason);
+        }
     } else {
         if (debug() >= 5)
             std::cout << "Element " << name << " splitting incoming data structure to "
                       << elements.size() << " child elements" << std::endl;
 
         if (value.type() == OpcUaType_ExtensionObject) {
+            const bool timed = debug() > 0;
+            epicsTime start;
+            if (timed)
+                start = epicsTime::getCurrent();
+            if (mapped && pitem->usePlannedDecoder() && decodePlanned(value, reason)) {
+                addDecodeStats(plannedStats, timed, start);
+                return;
+            }
+
             UaExtensionObject extensionObject;
             value.toExtensionObject(extensionObject);
 
             // Try to get the structure definition from the dictionary
-            UaStructureDefinition definition = pitem->structureDefinition(extensionObject.encodingTypeId());
+            const UaStructureDefinition &definition = structureDefinition(extensionObject.encodingTypeId());
             if (!definition.isNull()) {
                 if (!definition.isUnion()) {
                     // ExtensionObject is a structure
@@ -253,28 +398,52 @@ DataElementUaSdk::setIncomingData (const UaVariant &value)
                     genericValue.setGenericValue(extensionObject, definition);
 
                     if (!mapped) {
+                        // Resolve child names (and array indices) once into index paths
                         if (debug() >= 5)
-                            std::cout << " ** creating index-to-element map for child elements" << std::endl;
-                        for (auto &it : elements) {
-                            auto pelem = it.lock();
-                            for (int i = 0; i < definition.childrenCount(); i++) {
-                                if (pelem->name == definition.child(i).name().toUtf8()) {
-                                    elementMap.insert({i, it});
-                                    pelem->setIncomingData(genericValue.value(i));
+                            std::cout << " ** creating index paths for child elements" << std::endl;
+                        for (unsigned int k = firstChild; k < firstChild + noOfChildren; k++) {
+                            DataElementUaSdk *pelem = pitem->elementTable[k];
+                            int i;
+                            for (i = 0; i < definition.childrenCount(); i++) {
+                                if (pelem->fieldName == definition.child(i).name().toUtf8()) {
+                                    childPaths.push_back(ChildPath{i, pelem->arrayIndex, k});
+                                    break;
                                 }
                             }
+                            if (i == definition.childrenCount())
+                                errlogPrintf("OPC UA: element %s not found in structure %s - "
+                                             "check element path\n",
+                                             pelem->name.c_str(), definition.name().toUtf8());
                         }
+                        std::stable_sort(childPaths.begin(), childPaths.end(),
+                                         [](const ChildPath &a, const ChildPath &b) { return a.field < b.field; });
                         if (debug() >= 5)
-                            std::cout << " ** " << elementMap.size() << "/" << elements.size()
+                            std::cout << " ** " << childPaths.size() << "/" << elements.size()
                                       << " child elements mapped to a "
                                       << "structure of " << definition.childrenCount() << " elements" << std::endl;
                         mapped = true;
-                    } else {
-                        for (auto &it : elementMap) {
-                            auto pelem = it.second.lock();
-                            pelem->setIncomingData(genericValue.value(it.first));
+                    }
+                    // childPaths is sorted by field: get each field's value once per update
+                    UaVariant fieldValue;
+                    int field = -1;
+                    for (auto &it : childPaths) {
+                        DataElementUaSdk *pelem = pitem->elementTable[it.element];
+                        if (it.field != field) {
+                            field = it.field;
+                            fieldValue = genericValue.value(field);
+                        }
+                        if (it.arrayIndex < 0) {
+                            pelem->setIncomingData(fieldValue, reason);
+                        } else {
+                            UaVariant element;
+                            if (arrayElement(fieldValue, it.arrayIndex, element))
+                                pelem->setIncomingData(element, reason);
+                            else if (debug())
+                                std::cout << "Element " << pelem->name << ": array index out of range"
+                                          << " or not an array" << std::endl;
                         }
                     }
+                    addDecodeStats(genericStats, timed, start);
                 }
 
             } else
@@ -284,15 +453,96 @@ DataElementUaSdk::setIncomingData (const UaVariant &value)
     }
 }
 
+void
+DataElementUaSdk::addDecodeStats (DecodeStats &stats, const bool timed, const epicsTime &start)
+{
+    if (timed)
+        stats.add(epicsTime::getCurrent() - start);
+    else
+        stats.add();
+}
+
+const UaStructureDefinition &
+DataElementUaSdk::structureDefinition (const UaNodeId &encodingTypeId)
+{
+    const int generation = pitem->structureGeneration();
+    if (definitionGeneration != generation || encodingTypeId != definitionEncoding) {
+        definition = pitem->structureDefinition(encodingTypeId);
+        definitionEncoding = encodingTypeId;
+        // A failed lookup is retried with the next update
+        definitionGeneration = definition.isNull() ? -1 : generation;
+    }
+    return definition;
+}
+
+void
+DataElementUaSdk::compileDecoder (const UaNodeId &encodingTypeId)
+{
+    std::vector<int> wanted;
+
+    decoderEncoding = encodingTypeId;
+    decoderGeneration = pitem->structureGeneration();
+    decoderTargets.clear();
+    decoder.reset();
+    bool indexed = false;
+    for (auto &it : childPaths) {
+        if (it.arrayIndex >= 0)
+            indexed = true;
+        wanted.push_back(it.field);
+        decoderTargets.push_back(it.element);
+    }
+    // Elements of array fields are left to the generic decoder
+    if (!indexed)
+        decoder = StructDecoderUaSdk::compile(structureDefinition(encodingTypeId), wanted);
+    if (debug() >= 5) {
+        if (decoder)
+            std::cout << "Element " << name << " compiled decoding plan for "
+                      << wanted.size() << " mapped child elements ("
+                      << decoder->noOfSteps() << " steps)" << std::endl;
+        else
+            std::cout << "Element " << name << " cannot use a decoding plan for structure "
+                      << encodingTypeId.toString().toUtf8() << " - using generic decoder" << std::endl;
+    }
+}
+
+bool
+DataElementUaSdk::decodePlanned (const UaVariant &value, const ProcessReason reason)
+{
+    if (value.isArray())
+        return false;
+    const OpcUa_ExtensionObject *extensionObject
+            = static_cast<const OpcUa_Variant *>(value)->Value.ExtensionObject;
+    if (!extensionObject || extensionObject->Encoding != OpcUa_ExtensionObjectEncoding_Binary)
+        return false;
+
+    UaNodeId encodingTypeId(extensionObject->TypeId.NodeId);
+    if (decoderEncoding.isNull() || encodingTypeId != decoderEncoding
+            || decoderGeneration != pitem->structureGeneration())
+        compileDecoder(encodingTypeId);
+    if (!decoder || !decoder->decode(extensionObject->Body.Binary, decodedValues))
+        return false;
+
+    for (size_t i = 0; i < decoderTargets.size(); i++)
+        pitem->elementTable[decoderTargets[i]]->setIncomingData(decodedValues[i], reason);
+    return true;
+}
+
 epicsTimeStamp
 DataElementUaSdk::readTimeStamp (bool server) const
 {
-    epicsTimeStamp *ts;
+    const epicsTimeStamp *ts;
 
-    if (server)
+    if (isLeaf()) {
+        // Time stamps of the value snapshot
+        if (server)
+            ts = &incoming().tsServer;
+        else
+            ts = &incoming().tsSource;
+    } else if (server) {
         ts = &pitem->tsServer;
-    else
+    } else {
         ts = &pitem->tsSource;
+    }
 
     if (isLeaf() && debug()) {
         char time_buf[40];
@@ -309,16 +559,16 @@ DataElementUaSdk::readTimeStamp (bool server) const
 void
 DataElementUaSdk::checkScalar (const std::string &name) const
 {
-    if (incomingData.isEmpty())
+    if (incoming().data.isEmpty())
         throw std::runtime_error(SB() << "no incoming data");
 
     if (isLeaf() && debug()) {
         std::cout << pconnector->getRecordName() << ": reading ";
-        if (incomingData.type() == OpcUaType_String)
-            std::cout << "'" << incomingData.toString().toUtf8() << "'";
+        if (incoming().data.type() == OpcUaType_String)
+            std::cout << "'" << incoming().data.toString().toUtf8() << "'";
         else
-            std::cout << incomingData.toString().toUtf8();
-        std::cout << " (" << variantTypeString(incomingData.type()) << ")"
+            std::cout << incoming().data.toString().toUtf8();
+        std::cout << " (" << variantTypeString(incoming().data.type()) << ")"
                   << " as " << name << std::endl;
     }
 }
@@ -328,18 +578,18 @@ DataElementUaSdk::checkReadArray (OpcUa_BuiltInType expectedType,
                                   const epicsUInt32 num,
                                   const std::string &name) const
 {
-    if (incomingData.isEmpty())
+    if (incoming().data.isEmpty())
         throw std::runtime_error(SB() << "no incoming data");
-    if (!incomingIsArray)
+    if (!incoming().data.isArray())
         throw std::runtime_error(SB() << "incoming data is not an array");
-    if (incomingType != expectedType)
+    if (incoming().data.type() != expectedType)
         throw std::runtime_error(SB() << "incoming array data type ("
-                                 << variantTypeString(incomingData.type()) << ")"
+                                 << variantTypeString(incoming().data.type()) << ")"
                                  << " does not match EPICS array type (" << name << ")");
     if (isLeaf() && debug()) {
         std::cout << pconnector->getRecordName() << ": reading"
-                  << " array of " << variantTypeString(incomingData.type())
-                  << "[" << incomingData.arraySize() << "]"
+                  << " array of " << variantTypeString(incoming().data.type())
+                  << "[" << incoming().data.arraySize() << "]"
                   << " into " << name << "[" << num << "]" << std::endl;
     }
 }
@@ -350,7 +600,7 @@ DataElementUaSdk::readInt32 () const
     checkScalar("Int32");
 
     OpcUa_Int32 v;
-    if (OpcUa_IsNotGood(incomingData.toInt32(v)))
+    if (OpcUa_IsNotGood(incoming().data.toInt32(v)))
         throw std::runtime_error(SB() << "incoming data out-of-bounds");
     return v;
 }
@@ -361,7 +611,7 @@ DataElementUaSdk::readInt64 () const
     checkScalar("Int64");
 
     OpcUa_Int64 v;
-    if (OpcUa_IsNotGood(incomingData.toInt64(v)))
+    if (OpcUa_IsNotGood(incoming().data.toInt64(v)))
         throw std::runtime_error(SB() << "incoming data out-of-bounds");
     return v;
 }
@@ -372,7 +622,7 @@ DataElementUaSdk::readUInt32 () const
     checkScalar("UInt32");
 
     OpcUa_UInt32 v;
-    if (OpcUa_IsNotGood(incomingData.toUInt32(v)))
+    if (OpcUa_IsNotGood(incoming().data.toUInt32(v)))
         throw std::runtime_error(SB() << "incoming data out-of-bounds");
     return v;
 }
@@ -383,7 +633,7 @@ DataElementUaSdk::readFloat64 () const
     checkScalar("Float64");
 
     OpcUa_Double v;
-    if (OpcUa_IsNotGood(incomingData.toDouble(v)))
+    if (OpcUa_IsNotGood(incoming().data.toDouble(v)))
         throw std::runtime_error(SB() << "incoming data out-of-bounds");
     return v;
 }
@@ -391,21 +641,21 @@ DataElementUaSdk::readFloat64 () const
 void
 DataElementUaSdk::readCString (char *value, const size_t num) const
 {
-    if (incomingData.isEmpty())
+    if (incoming().data.isEmpty())
         throw std::runtime_error(SB() << "no incoming data");
 
     if (isLeaf() && debug()) {
         std::cout << pconnector->getRecordName() << ": reading ";
-        if (incomingData.type() == OpcUaType_String)
-            std::cout << "'" << incomingData.toString().toUtf8() << "'";
+        if (incoming().data.type() == OpcUaType_String)
+            std::cout << "'" << incoming().data.toString().toUtf8() << "'";
         else
-            std::cout << incomingData.toString().toUtf8();
-        std::cout << " (" << variantTypeString(incomingData.type()) << ")"
+            std::cout << incoming().data.toString().toUtf8();
+        std::cout << " (" << variantTypeString(incoming().data.type()) << ")"
                   << " as CString [" << num << "]" << std::endl;
     }
 
     if (num > 0) {
-        strncpy(value, incomingData.toString().toUtf8(), num);
+        strncpy(value, incoming().data.toString().toUtf8(), num);
         value[num-1] = '\0';
     }
 }
@@ -416,7 +666,7 @@ DataElementUaSdk::readArrayInt8 (epicsInt8 *value, epicsUInt32 num) const
     checkReadArray(OpcUaType_SByte, num, "epicsInt8");
 
     UaSByteArray arr;
-    incomingData.toSByteArray(arr);
+    incoming().data.toSByteArray(arr);
     epicsUInt32 no_elems = num < arr.length() ? num : arr.length();
     memcpy(value, arr.rawData(), sizeof(epicsInt8) * no_elems);
 
@@ -429,7 +679,7 @@ DataElementUaSdk::readArrayUInt8 (epicsUInt8 *value, epicsUInt32 num) const
     checkReadArray(OpcUaType_Byte, num, "epicsUInt8");
 
     UaByteArray arr;
-    incomingData.toByteArray(arr);
+    incoming().data.toByteArray(arr);
     epicsUInt32 no_elems = static_cast<epicsUInt32>(arr.size());
     if (num < no_elems) no_elems = num;
     memcpy(value, arr.data(), sizeof(epicsUInt8) * no_elems);
@@ -443,7 +693,7 @@ DataElementUaSdk::readArrayInt16 (epicsInt16 *value, epicsUInt32 num) const
     checkReadArray(OpcUaType_Int16, num, "epicsInt16");
 
     UaInt16Array arr;
-    incomingData.toInt16Array(arr);
+    incoming().data.toInt16Array(arr);
     epicsUInt32 no_elems = num < arr.length() ? num : arr.length();
     memcpy(value, arr.rawData(), sizeof(epicsInt16) * no_elems);
 
@@ -456,7 +706,7 @@ DataElementUaSdk::readArrayUInt16 (epicsUInt16 *value, epicsUInt32 num) const
     checkReadArray(OpcUaType_UInt16, num, "epicsUInt16");
 
     UaUInt16Array arr;
-    incomingData.toUInt16Array(arr);
+    incoming().data.toUInt16Array(arr);
     epicsUInt32 no_elems = num < arr.length() ? num : arr.length();
     memcpy(value, arr.rawData(), sizeof(epicsUInt16) * no_elems);
 
@@ -469,7 +719,7 @@ DataElementUaSdk::readArrayInt32 (epicsInt32 *value, epicsUInt32 num) const
     checkReadArray(OpcUaType_Int32, num, "epicsInt32");
 
     UaInt32Array arr;
-    incomingData.toInt32Array(arr);
+    incoming().data.toInt32Array(arr);
     epicsUInt32 no_elems = num < arr.length() ? num : arr.length();
     memcpy(value, arr.rawData(), sizeof(epicsInt32) * no_elems);
 
@@ -482,7 +732,7 @@ DataElementUaSdk::readArrayUInt32 (epicsUInt32 *value, epicsUInt32 num) const
     checkReadArray(OpcUaType_UInt32, num, "epicsUInt32");
 
     UaUInt32Array arr;
-    incomingData.toUInt32Array(arr);
+    incoming().data.toUInt32Array(arr);
     epicsUInt32 no_elems = num < arr.length() ? num : arr.length();
     memcpy(value, arr.rawData(), sizeof(epicsUInt32) * no_elems);
 
@@ -495,7 +745,7 @@ DataElementUaSdk::readArrayInt64 (epicsInt64 *value, epicsUInt32 num) const
     checkReadArray(OpcUaType_Int64, num, "epicsInt64");
 
     UaInt64Array arr;
-    incomingData.toInt64Array(arr);
+    incoming().data.toInt64Array(arr);
     epicsUInt32 no_elems = num < arr.length() ? num : arr.length();
     memcpy(value, arr.rawData(), sizeof(epicsInt64) * no_elems);
 
@@ -508,7 +758,7 @@ DataElementUaSdk::readArrayUInt64 (epicsUInt64 *value, epicsUInt32 num) const
     checkReadArray(OpcUaType_UInt64, num, "epicsUInt64");
 
     UaUInt64Array arr;
-    incomingData.toUInt64Array(arr);
+    incoming().data.toUInt64Array(arr);
     epicsUInt32 no_elems = num < arr.length() ? num : arr.length();
     memcpy(value, arr.rawData(), sizeof(epicsUInt64) * no_elems);
 
@@ -521,7 +771,7 @@ DataElementUaSdk::readArrayFloat32 (epicsFloat32 *value, epicsUInt32 num) const
     checkReadArray(OpcUaType_Float, num, "epicsFloat32");
 
     UaFloatArray arr;
-    incomingData.toFloatArray(arr);
+    incoming().data.toFloatArray(arr);
     epicsUInt32 no_elems = num < arr.length() ? num : arr.length();
     memcpy(value, arr.rawData(), sizeof(epicsFloat32) * no_elems);
 
@@ -534,7 +784,7 @@ DataElementUaSdk::readArrayFloat64 (epicsFloat64 *value, epicsUInt32 num) const
     checkReadArray(OpcUaType_Double, num, "epicsFloat64");
 
     UaDoubleArray arr;
-    incomingData.toDoubleArray(arr);
+    incoming().data.toDoubleArray(arr);
     epicsUInt32 no_elems = num < arr.length() ? num : arr.length();
     memcpy(value, arr.rawData(), sizeof(epicsFloat64) * no_elems);
 
@@ -547,7 +797,7 @@ DataElementUaSdk::readArrayOldString (epicsOldString *value, epicsUInt32 num) co
     checkReadArray(OpcUaType_String, num, "epicsOldString");
 
     UaStringArray arr;
-    incomingData.toStringArray(arr);
+    incoming().data.toStringArray(arr);
     epicsUInt32 no_elems = num < arr.length() ? num : arr.length();
     for (epicsUInt32 i = 0; i < num; i++) {
         strncpy(value[i], UaString(arr[i]).toUtf8(), MAX_STRING_SIZE);
@@ -581,13 +831,177 @@ DataElementUaSdk::writeWasOk () const
     return status;
 }
 
+bool
+DataElementUaSdk::takesCompletion () const
+{
+    return incomingQueue && (pconnector->reason == ProcessReason::readComplete
+                             || pconnector->reason == ProcessReason::writeComplete);
+}
+
+void
+DataElementUaSdk::handOff (const UaVariant &value,
+                           const epicsTimeStamp &tsSource,
+                           const epicsTimeStamp &tsServer,
+                           const ProcessReason reason)
+{
+    // Lock-free handoff to the record
+    // A completion must not wait behind the queued updates: it goes to the completion slot
+    if (incomingQueue && reason == ProcessReason::incomingData) {
+        if (IncomingValue *slot = incomingQueue->claim()) {
+            slot->data = value;
+            slot->tsSource = tsSource;
+            slot->tsServer = tsServer;
+            incomingQueue->publish();
+        }
+    } else {
+        IncomingValue &back = incomingValues.writeBuffer();
+        back.data = value;
+        back.tsSource = tsSource;
+        back.tsServer = tsServer;
+        if (incomingValues.publish())
+            epics::atomic::increment(overwritten);
+    }
+    epics::atomic::set(valueReady, 1);
+}
+
+bool
+DataElementUaSdk::isDuplicate (const UaVariant &value, const ProcessReason reason)
+{
+    const epicsTimeStamp &ts = pconnector->plinkinfo->useServerTimestamp ? pitem->tsServer : pitem->tsSource;
+    const OpcUa_StatusCode status = pitem->getReadStatus().code();
+
+    if (reason != ProcessReason::incomingData) {
+        duplicateFilter->handedOn(value, status, ts);
+        return false;
+    }
+    return duplicateFilter->check(value, status, ts);
+}
+
+void
+DataElementUaSdk::packSample (const UaVariant &value)
+{
+    const linkInfo &info = *pconnector->plinkinfo;
+    const bool first = packer->isEmpty();
+
+    if (!packer->add(value, info.useServerTimestamp ? pitem->tsServer : pitem->tsSource)) {
+        if (debug())
+            std::cout << pconnector->getRecordName() << ": cannot pack incoming "
+                      << (value.isArray() ? "array of " : "")
+                      << variantTypeString(value.type()) << " - sample dropped" << std::endl;
+        return;
+    }
+    if (packer->isFull())
+        deliverBlock(ProcessReason::incomingData);
+    else if (first && info.packTime > 0.0)
+        pitem->session->addSampleDeadline(info.packTime / 1e3, SampleDeadline{this, packer->currentBlock()});
+}
+
+void
+DataElementUaSdk::deliverBlock (const ProcessReason reason)
+{
+    UaVariant block;
+    const epicsTimeStamp ts = packer->firstTimeStamp();
+    packer->take(block);
+    handOff(block, ts, ts, reason);
+}
+
+void
+DataElementUaSdk::aggregateSample (const UaVariant &value)
+{
+    const linkInfo &info = *pconnector->plinkinfo;
+    const bool first = aggregator->isEmpty();
+    OpcUa_Double v;
+
+    if (value.isArray() || OpcUa_IsNotGood(value.toDouble(v))) {
+        if (debug())
+            std::cout << pconnector->getRecordName() << ": cannot aggregate incoming "
+                      << (value.isArray() ? "array of " : "")
+                      << variantTypeString(value.type()) << " - sample dropped" << std::endl;
+        return;
+    }
+    aggregator->add(v, info.useServerTimestamp ? pitem->tsServer : pitem->tsSource);
+    if (aggregator->isFull())
+        deliverWindow(ProcessReason::incomingData);
+    else if (first && info.windowTime > 0.0)
+        pitem->session->addSampleDeadline(info.windowTime / 1e3,
+                                          SampleDeadline{this, aggregator->currentWindow()});
+}
+
+void
+DataElementUaSdk::deliverWindow (const ProcessReason reason)
+{
+    UaVariant result;
+    epicsTimeStamp ts;
+    result.setDouble(aggregator->take(ts));
+    handOff(result, ts, ts, reason);
+}
+
+void
+DataElementUaSdk::blockTimeout (const epicsUInt32 block)
+{
+    {
+        Guard G(pitem->updateLock);
+        if (packer) {
+            if (packer->isEmpty() || packer->currentBlock() != block)
+                return;   // block was delivered in time
+            deliverBlock(ProcessReason::incomingData);
+        } else if (aggregator) {
+            if (aggregator->isEmpty() || aggregator->currentWindow() != block)
+                return;   // window was delivered in time
+            deliverWindow(ProcessReason::incomingData);
+        } else {
+            return;
+        }
+    }
+    requestRecordProcessing(ProcessReason::incomingData);
+}
+
 void DataElementUaSdk::clearIncomingData()
 {
-    incomingData.clear();
+    if (snapshotTaken) {
+        if (incomingQueue) {
+            if (takesCompletion()) {
+                incomingValues.readBuffer().data.clear();
+            } else if (queued) {
+                queued->data.clear();
+                incomingQueue->pop();
+                queued = nullptr;
+            }
+            // Process the record again for the next queued value
+            if (pconnector->reason == ProcessReason::incomingData)
+                epics::atomic::set(processingRequested, 0);
+            if (!incomingQueue->isEmpty()
+                    && epics::atomic::compareAndSwap(processingRequested, 0, 1) == 0
+                    && !pconnector->requestRecordProcessing(ProcessReason::incomingData))
+                epics::atomic::set(processingRequested, 0);
+        } else {
+            incomingValues.readBuffer().data.clear();
+        }
+        snapshotTaken = false;
+    }
     if (isLeaf())
         pconnector->reason = ProcessReason::none;
 }
 
+const DataElementUaSdk::IncomingValue &
+DataElementUaSdk::incoming () const
+{
+    static const IncomingValue noValue = IncomingValue();
+
+    if (incomingQueue && !takesCompletion()) {
+        if (!snapshotTaken) {
+            queued = incomingQueue->front();
+            snapshotTaken = true;
+        }
+        return queued ? *queued : noValue;
+    }
+    if (!snapshotTaken) {
+        incomingValues.acquire();
+        snapshotTaken = true;
+    }
+    return incomingValues.readBuffer();
+}
+
 template<typename FROM, typename TO>
 void checkRange (const FROM &value) {
     if (value < std::numeric_limits<TO>::min() || value > std::numeric_limits<TO>::max())
@@ -1125,13 +1539,52 @@ void
 DataElementUaSdk::requestRecordProcessing (const ProcessReason reason) const
 {
     if (isLeaf()) {
-        pconnector->requestRecordProcessing(reason);
-    } else {
-        for (auto &it : elementMap) {
-            auto pelem = it.second.lock();
-            pelem->requestRecordProcessing(reason);
+        if (reason == ProcessReason::incomingData) {
+            // Packing/aggregating samples: process the record once per block or window
+            // Dropping duplicates: process the record only for updates that were handed over
+            if (packer || aggregator || pconnector->plinkinfo->dropDuplicates) {
+                if (epics::atomic::compareAndSwap(valueReady, 1, 0) != 1)
+                    return;
+            } else {
+                epics::atomic::set(valueReady, 0);
+            }
+        } else if (reason == ProcessReason::readComplete) {
+            // The record is waiting (PACT) for the read, never suppress its completion
+            epics::atomic::set(valueReady, 0);
+        }
+        if (incomingQueue) {
+            if (reason == ProcessReason::incomingData) {
+                // One pending processing per leaf: the record asks for the next one
+                // after taking a value from the queue (see clearIncomingData)
+                if (epics::atomic::compareAndSwap(processingRequested, 0, 1) != 0)
+                    return;
+            } else if (reason == ProcessReason::connectionLoss && pconnector->isIoIntrScanned) {
+                // I/O Intr scanning keeps a single reason, a pending request gets replaced
+                epics::atomic::set(processingRequested, 0);
+            }
         }
+        // The record goes INVALID: the first update after reconnecting must get through
+        if (reason == ProcessReason::connectionLoss && duplicateFilter)
+            duplicateFilter->reset();
+        if (!pconnector->requestRecordProcessing(reason))
+            processingRequestFailed(reason);
+    } else {
+        for (unsigned int k = firstChild; k < firstChild + noOfChildren; k++)
+            pitem->elementTable[k]->requestRecordProcessing(reason);
     }
 }
 
+void
+DataElementUaSdk::processingRequestFailed (const ProcessReason reason) const
+{
+    if (!isLeaf())
+        return;
+    // The handed over block/window/update is still waiting for the record
+    if (reason == ProcessReason::incomingData
+            && (packer || aggregator || pconnector->plinkinfo->dropDuplicates))
+        epics::atomic::set(valueReady, 1);
+    if (incomingQueue && reason == ProcessReason::incomingData)
+        epics::atomic::set(processingRequested, 0);
+}
+
 } // namespace DevOpcua
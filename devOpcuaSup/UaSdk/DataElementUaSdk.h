@@ -14,15 +14,23 @@
 #ifndef DEVOPCUA_DATAELEMENTUASDK_H
 #define DEVOPCUA_DATAELEMENTUASDK_H
 
-#include <unordered_map>
+#include <vector>
 
 #include <uadatavalue.h>
 #include <statuscode.h>
 
+#include <epicsAtomic.h>
+
 #include "DataElement.h"
+#include "TripleBuffer.h"
+#include "RingBuffer.h"
 #include "devOpcua.h"
 #include "RecordConnector.h"
 #include "ItemUaSdk.h"
+#include "StructDecoderUaSdk.h"
+#include "SamplePackerUaSdk.h"
+#include "Aggregator.h"
+#include "DuplicateFilter.h"
 
 namespace DevOpcua {
 
@@ -35,6 +43,8 @@ class ItemUaSdk;
  */
 class DataElementUaSdk : public DataElement
 {
+    friend class ItemUaSdk;
+
 public:
     /**
      * @brief Constructor for DataElement from record connector.
@@ -91,9 +101,10 @@ public:
      * Called from the OPC UA client worker thread when new data is
      * received from the OPC UA session.
      *
-     * @param value  new value for this data element
+     * @param value   new value for this data element
+     * @param reason  reason for the update (incomingData = monitored, readComplete = read)
      */
-    void setIncomingData(const UaVariant &value);
+    void setIncomingData(const UaVariant &value, const ProcessReason reason);
 
     /**
      * @brief Get the outgoing data value from the DataElement.
@@ -438,6 +449,22 @@ public:
      */
     virtual void requestRecordProcessing(const ProcessReason reason) const override;
 
+    /**
+     * @brief Undo the bookkeeping of a rejected processing request.
+     * See DevOpcua::DataElement::processingRequestFailed
+     */
+    virtual void processingRequestFailed(const ProcessReason reason) const override;
+
+    /**
+     * @brief Deliver a block of packed samples or an aggregation window after its time limit.
+     *
+     * Called when the time limit (packtime/windowtime) of a block or window
+     * expires. Does nothing if it has already been delivered.
+     *
+     * @param block  sequence number of the block or window
+     */
+    void blockTimeout(const epicsUInt32 block);
+
     /**
      * @brief Get debug level from record (via RecordConnector)`.
      * @return debug level
@@ -445,6 +472,135 @@ public:
     int debug() const { return (isLeaf() ? pconnector->debug() : pitem->debug()); }
 
 private:
+    /**
+     * @brief An incoming value with its time stamps (handed from the client library to the record).
+     */
+    struct IncomingValue {
+        UaVariant data;             /**< incoming value */
+        epicsTimeStamp tsSource;    /**< device time stamp */
+        epicsTimeStamp tsServer;    /**< server time stamp */
+    };
+
+    /**
+     * @brief Get the incoming value snapshot (record side).
+     *
+     * Acquires the latest published value (or, if the element has a value queue,
+     * the oldest queued value) on the first access after clearIncomingData,
+     * so that all reads during one record processing see the same value
+     * and time stamps. With a value queue, a read or write completion takes
+     * its value from the completion slot instead.
+     *
+     * @return incoming value snapshot
+     */
+    const IncomingValue &incoming() const;
+
+    /**
+     * @brief Check if the record processing takes its value from the completion slot (leaf).
+     *
+     * @return true if the element has a value queue and the record processes a completion
+     */
+    bool takesCompletion() const;
+
+    /**
+     * @brief Hand an incoming value to the record (leaf).
+     *
+     * With a value queue, completion values bypass the queued monitored updates.
+     *
+     * @param value     incoming value
+     * @param tsSource  device time stamp
+     * @param tsServer  server time stamp
+     * @param reason    reason for the update
+     */
+    void handOff(const UaVariant &value, const epicsTimeStamp &tsSource, const epicsTimeStamp &tsServer,
+                 const ProcessReason reason);
+
+    /**
+     * @brief Check an incoming monitored update against the last value handed on (leaf).
+     *
+     * Compares value, status and (for dedup=timestamp) time stamp.
+     * Values that are handed on are remembered for the next check.
+     *
+     * @param value   incoming value
+     * @param reason  reason for the update (only monitored updates are dropped)
+     *
+     * @return true if the update is a duplicate and has to be dropped
+     */
+    bool isDuplicate(const UaVariant &value, const ProcessReason reason);
+
+    /**
+     * @brief Add an incoming scalar sample to the current block (leaf in pack mode).
+     *
+     * @param value  incoming value
+     */
+    void packSample(const UaVariant &value);
+
+    /**
+     * @brief Hand the current block of packed samples to the record.
+     *
+     * @param reason  reason for the delivery
+     */
+    void deliverBlock(const ProcessReason reason);
+
+    /**
+     * @brief Add an incoming sample to the current window (leaf in aggregation mode).
+     *
+     * @param value  incoming value
+     */
+    void aggregateSample(const UaVariant &value);
+
+    /**
+     * @brief Hand the result of the current aggregation window to the record.
+     *
+     * @param reason  reason for the delivery
+     */
+    void deliverWindow(const ProcessReason reason);
+
+    /**
+     * @brief Usage and timing statistics of a structure decoder.
+     *
+     * Decoding is only timed while debugging is enabled (costs two clock reads per update).
+     */
+    struct DecodeStats {
+        unsigned long count = 0;  /**< number of decoded updates */
+        unsigned long timed = 0;  /**< number of timed updates */
+        double time = 0.0;        /**< accumulated decoding time of the timed updates [s] */
+        void add() { count++; }
+        void add(const double t) { count++; timed++; time += t; }
+        double average() const { return timed ? time / timed * 1e6 : 0.0; }  /**< [us] */
+    };
+
+    /**
+     * @brief Count a decoded update, add its decoding time if it was timed.
+     */
+    static void addDecodeStats(DecodeStats &stats, const bool timed, const epicsTime &start);
+
+    /**
+     * @brief Get the structure definition for an encoding type (cached in the node).
+     *
+     * The session dictionary is only consulted when the encoding type changes
+     * or the session's definitions have been invalidated (new session).
+     *
+     * @param encodingTypeId  encoding type of the incoming ExtensionObject
+     */
+    const UaStructureDefinition &structureDefinition(const UaNodeId &encodingTypeId);
+
+    /**
+     * @brief Compile the decoding plan for the mapped child elements.
+     *
+     * @param encodingTypeId  encoding type of the incoming ExtensionObject
+     */
+    void compileDecoder(const UaNodeId &encodingTypeId);
+
+    /**
+     * @brief Decode an incoming ExtensionObject using the decoding plan.
+     *
+     * @param value   incoming ExtensionObject
+     * @param reason  reason for the update
+     *
+     * @return true if successful, false if the generic decoder has to be used
+     */
+    bool decodePlanned(const UaVariant &value, const ProcessReason reason);
+
     void logWriteScalar () const;
     void checkScalar(const std::string &type) const;
     void checkReadArray(OpcUa_BuiltInType expectedType, const epicsUInt32 num, const std::string &name) const;
@@ -455,12 +611,55 @@ private:
     std::vector<std::weak_ptr<DataElementUaSdk>> elements;  /**< children (if node) */
     std::shared_ptr<DataElementUaSdk> parent;               /**< parent */
 
-    std::unordered_map<int,std::weak_ptr<DataElementUaSdk>> elementMap;
+    /**
+     * @brief Precomputed path from a structure node to one of its child elements.
+     */
+    struct ChildPath {
+        int field;                              /**< index of the field in the structure */
+        int arrayIndex;                         /**< index into an array field (-1 = not indexed) */
+        unsigned int element;                   /**< index of the child in the item's element table */
+    };
+
+    /**
+     * @brief Split an element name into field name and array index.
+     *
+     * "name[idx]" selects element idx of the array field "name".
+     */
+    void parseArrayIndex();
 
+    unsigned int firstChild;         /**< index of the first child in the item's element table */
+    unsigned int noOfChildren;       /**< number of children (contiguous in the element table) */
+    std::vector<ChildPath> childPaths;  /**< children mapped to structure fields (index paths, sorted by field) */
+    std::string fieldName;           /**< name of the structure field (without array index) */
+    int arrayIndex;                  /**< array index (from name[idx]; -1 = none) */
     bool mapped;                     /**< child name to index mapping done */
-    UaVariant incomingData;          /**< incoming value */
-    OpcUa_BuiltInType incomingType;  /**< type of incoming data */
-    bool incomingIsArray;            /**< array property of incoming data */
+    UaStructureDefinition definition;  /**< structure definition of the incoming data (cached) */
+    UaNodeId definitionEncoding;     /**< encoding type id of the cached definition */
+    int definitionGeneration;        /**< session definitions generation of the cached definition */
+    std::unique_ptr<StructDecoderUaSdk> decoder;  /**< decoding plan for mapped children (if node) */
+    UaNodeId decoderEncoding;        /**< encoding type id that the plan was compiled for */
+    int decoderGeneration;           /**< session definitions generation that the plan was compiled for */
+    /** child elements in the order of the decoder outputs */
+    std::vector<unsigned int> decoderTargets;
+    std::vector<UaVariant> decodedValues;  /**< decoder output (reused) */
+    DecodeStats plannedStats;        /**< timing of planned decoding */
+    DecodeStats genericStats;        /**< timing of generic decoding */
+    OpcUa_BuiltInType incomingType;  /**< type of latest incoming data */
+    bool incomingIsArray;            /**< array property of latest incoming data */
+    /** incoming values (leaf): lock-free handoff from client library to record;
+     *  with a value queue: completion slot for read and write results */
+    mutable TripleBuffer<IncomingValue> incomingValues;
+    /** incoming values (leaf, queue size > 1): queue processing the record once per value */
+    std::unique_ptr<RingBuffer<IncomingValue>> incomingQueue;
+    mutable IncomingValue *queued;   /**< value taken from the queue by the record */
+    mutable int processingRequested; /**< a record processing for queued data is pending */
+    mutable bool snapshotTaken;      /**< record holds an acquired snapshot */
+    int overwritten;                 /**< number of values overwritten before the record read them */
+    std::unique_ptr<SamplePackerUaSdk> packer;  /**< packs scalar samples into blocks (leaf in pack mode) */
+    std::unique_ptr<Aggregator> aggregator;     /**< aggregates samples over windows (leaf in aggregation mode) */
+    mutable int valueReady;          /**< a value has been handed to the record since the last request */
+    /** drops repeated monitored updates (leaf with dedup option) */
+    std::unique_ptr<DuplicateFilter<UaVariant>> duplicateFilter;
     UaVariant outgoingData;          /**< outgoing value */
 };
 
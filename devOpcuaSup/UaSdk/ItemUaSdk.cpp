@@ -12,11 +12,13 @@
  */
 
 #include <memory>
+#include <iomanip>
 
 #include <uaclientsdk.h>
 #include <uanodeid.h>
 
 #include "RecordConnector.h"
+#include "linkParser.h"
 #include "opcuaItemRecord.h"
 #include "ItemUaSdk.h"
 #include "SubscriptionUaSdk.h"
@@ -27,11 +29,20 @@ namespace DevOpcua {
 
 using namespace UaClientSdk;
 
+std::map<std::string, ItemUaSdk *> ItemUaSdk::sharedItems;
+
 ItemUaSdk::ItemUaSdk (const linkInfo &info)
     : Item(info)
     , subscription(nullptr)
     , session(nullptr)
+    , channel(0)
     , registered(false)
+    , monitoredItemId(0)
+    , hasLastValue(false)
+    , readPending(0)
+    , noOfRoots(0)
+    , frozen(0)
+    , noOfLinks(0)
 {
     rebuildNodeId();
 
@@ -39,15 +50,62 @@ ItemUaSdk::ItemUaSdk (const linkInfo &info)
         subscription = &SubscriptionUaSdk::findSubscription(linkinfo.subscription);
         subscription->addItemUaSdk(this);
         session = &subscription->getSessionUaSdk();
+        channel = subscription->getChannel();
     } else {
         session = &SessionUaSdk::findSession(linkinfo.session);
+        channel = session->channelForNode(*nodeid);
     }
     session->addItemUaSdk(this);
 }
 
+ItemUaSdk *
+ItemUaSdk::findOrCreateItem (const linkInfo &info)
+{
+    ItemUaSdk *pitem;
+
+    if (info.isOutput || info.isItemRecord) {
+        pitem = new ItemUaSdk(info);
+    } else {
+        // Everything that goes into the monitored item or read request
+        // (doubles with full precision: different settings must not share an item)
+        std::string key = SB() << std::setprecision(17) << info.session << "|" << info.subscription
+                               << "|" << info.namespaceIndex;
+        if (info.identifierIsNumeric)
+            key += SB() << "|i=" << info.identifierNumber;
+        else
+            key += SB() << "|s=" << info.identifierString;
+        key += SB() << std::setprecision(17) << "|" << info.samplingInterval << "|" << info.queueSize
+                    << "|" << info.discardOldest << "|" << info.registerNode
+                    << "|" << info.monitor << "|" << info.maxAge
+                    << "|" << deadbandString(info)
+                    << "|" << info.dataChangeTrigger
+                    << "|" << (info.element.empty() ? "leaf" : "struct");
+
+        auto it = sharedItems.find(key);
+        if (it != sharedItems.end()) {
+            pitem = it->second;
+        } else {
+            pitem = new ItemUaSdk(info);
+            pitem->sharedKey = key;
+            sharedItems.insert({key, pitem});
+        }
+    }
+    return pitem;
+}
+
+void
+ItemUaSdk::releaseItem (ItemUaSdk *item)
+{
+    if (!item->noOfLinks)
+        delete item;
+}
+
 ItemUaSdk::~ItemUaSdk ()
 {
-    subscription->removeItemUaSdk(this);
+    if (isShared())
+        sharedItems.erase(sharedKey);
+    if (subscription)
+        subscription->removeItemUaSdk(this);
     session->removeItemUaSdk(this);
 }
 
@@ -78,17 +136,26 @@ ItemUaSdk::show (int level) const
               << " sampling=" << linkinfo.samplingInterval
               << " qsize=" << linkinfo.queueSize
               << " discard=" << (linkinfo.discardOldest ? "old" : "new")
+              << " maxage=" << linkinfo.maxAge
+              << " deadband=" << deadbandString(linkinfo)
+              << " trigger=" << triggerString(linkinfo.dataChangeTrigger)
               << " timestamp=" << (linkinfo.useServerTimestamp ? "server" : "source")
               << " output=" << (linkinfo.isOutput ? "y" : "n")
               << " monitor=" << (linkinfo.monitor ? "y" : "n")
               << " registered=" << (registered ? nodeid->toString().toUtf8() : "-" )
               << "(" << (linkinfo.registerNode ? "y" : "n") << ")"
+              << " shared=" << (isShared() ? "y" : "n")
+              << "(" << noOfLinks << " records)"
               << std::endl;
 
     if (level >= 1) {
         if (auto re = rootElement.lock()) {
             re->show(level, 1);
         }
+        for (auto &it : rootLeaves) {
+            if (auto re = it.lock())
+                re->show(level, 1);
+        }
         std::cout.flush();
     }
 }
@@ -97,6 +164,8 @@ int ItemUaSdk::debug() const
 {
     if (linkinfo.isItemRecord)
         return itemRecord->tpro;
+    else if (isFrozen() && noOfRoots)
+        return elementTable[0]->debug();
     else if (auto pd = rootElement.lock())
         return pd->debug();
     else
@@ -104,11 +173,50 @@ int ItemUaSdk::debug() const
 }
 
 void
-ItemUaSdk::requestRecordProcessing (const ProcessReason reason) const
+ItemUaSdk::freeze ()
 {
-    if (auto pd = rootElement.lock()) {
-        pd->requestRecordProcessing(reason);
+    Guard G(freezeLock);
+    if (isFrozen())
+        return;
+
+    elementTable.clear();
+    if (auto pd = rootElement.lock())
+        elementTable.push_back(pd.get());
+    for (auto &it : rootLeaves) {
+        if (auto pd = it.lock())
+            elementTable.push_back(pd.get());
+    }
+    noOfRoots = static_cast<unsigned int>(elementTable.size());
+
+    // Breadth first: the children of each node end up contiguous
+    for (size_t n = 0; n < elementTable.size(); n++) {
+        DataElementUaSdk *pelem = elementTable[n];
+        pelem->firstChild = static_cast<unsigned int>(elementTable.size());
+        for (auto &it : pelem->elements) {
+            if (auto pchild = it.lock())
+                elementTable.push_back(pchild.get());
+        }
+        pelem->noOfChildren = static_cast<unsigned int>(elementTable.size()) - pelem->firstChild;
     }
+    epicsAtomicWriteMemoryBarrier();
+    epics::atomic::set(frozen, 1);
+}
+
+void
+ItemUaSdk::requestRecordProcessing (const ProcessReason reason)
+{
+    if (!isFrozen())
+        freeze();
+    for (unsigned int i = 0; i < noOfRoots; i++)
+        elementTable[i]->requestRecordProcessing(reason);
+}
+
+bool
+ItemUaSdk::isStructured() const
+{
+    if (auto pd = rootElement.lock())
+        return !pd->isLeaf();
+    return false;
 }
 
 const UaVariant &
@@ -139,18 +247,47 @@ ItemUaSdk::uaToEpicsTimeStamp (const UaDateTime &dt, const OpcUa_UInt16 pico10)
 }
 
 void
-ItemUaSdk::setIncomingData(const OpcUa_DataValue &value)
+ItemUaSdk::setIncomingData(const OpcUa_DataValue &value, const ProcessReason reason)
 {
+    if (linkinfo.maxAge > 0.0) {
+        Guard G(cacheLock);
+        lastValue = value;
+        tsReceived = epicsTime::getCurrent();
+        hasLastValue = true;
+    }
+    pushIncomingData(value, reason);
+}
+
+bool
+ItemUaSdk::readFromCache(const double maxAge)
+{
+    UaDataValue value;
+    {
+        Guard G(cacheLock);
+        if (!hasLastValue || (epicsTime::getCurrent() - tsReceived) * 1e3 > maxAge)
+            return false;
+        value = lastValue;
+    }
+    pushIncomingData(*static_cast<const OpcUa_DataValue *>(value), ProcessReason::readComplete);
+    return true;
+}
+
+void
+ItemUaSdk::pushIncomingData(const OpcUa_DataValue &value, const ProcessReason reason)
+{
+    // Serialize writers (subscription and read callbacks), records never take this lock
+    Guard G(updateLock);
     tsSource = uaToEpicsTimeStamp(UaDateTime(value.SourceTimestamp), value.SourcePicoseconds);
     tsServer = uaToEpicsTimeStamp(UaDateTime(value.ServerTimestamp), value.ServerPicoseconds);
 
     readStatus = value.StatusCode;
 
-    if (auto pd = rootElement.lock()) {
-        return pd->setIncomingData(value.Value);
-    } else {
+    if (!isFrozen())
+        freeze();
+    if (!noOfRoots)
         throw std::runtime_error(SB() << "stale pointer to root data element");
-    }
+    for (unsigned int i = 0; i < noOfRoots; i++)
+        elementTable[i]->setIncomingData(value.Value, reason);
 }
 
 } // namespace DevOpcua
@@ -15,10 +15,18 @@
 #define DEVOPCUA_ITEMUASDK_H
 
 #include <memory>
+#include <vector>
+#include <map>
+#include <string>
 
 #include <statuscode.h>
 #include <opcua_builtintypes.h>
 #include <uastructuredefinition.h>
+#include <uadatavalue.h>
+
+#include <epicsTime.h>
+#include <epicsMutex.h>
+#include <epicsAtomic.h>
 
 #include "Item.h"
 #include "opcuaItemRecord.h"
@@ -51,6 +59,64 @@ public:
     ItemUaSdk(const linkInfo &info);
     ~ItemUaSdk() override;
 
+    /**
+     * @brief Find or create the item for a record's link.
+     *
+     * Input links with identical node and item parameters share one item,
+     * i.e. one monitored item on the server, whose data is fanned out to
+     * all linked records. Output links always get their own item.
+     *
+     * The record is not counted as linked before addLink() is called.
+     *
+     * @param info  configuration as parsed from the EPICS database
+     * @return pointer to the (possibly shared) item
+     */
+    static ItemUaSdk *findOrCreateItem(const linkInfo &info);
+
+    /**
+     * @brief Release an item after linking a record to it failed.
+     *
+     * Deletes the item if no record has been linked to it.
+     *
+     * @param item  item returned by findOrCreateItem
+     */
+    static void releaseItem(ItemUaSdk *item);
+
+    /**
+     * @brief Count a record that has been linked to the item successfully.
+     */
+    void addLink() { noOfLinks++; }
+
+    /**
+     * @brief Return shared status (item may be linked to multiple records).
+     */
+    bool isShared() const { return !sharedKey.empty(); }
+
+    /**
+     * @brief Freeze the data element tree into a flat element table.
+     *
+     * Called after iocInit, when all records have been linked. The elements are
+     * entered breadth first, so that the children of every node are contiguous.
+     * Updates are then fanned out through the table using plain indices.
+     * No elements can be added to a frozen item.
+     */
+    void freeze();
+
+    /**
+     * @brief Return frozen status (see freeze).
+     */
+    bool isFrozen() const { return epics::atomic::get(frozen) != 0; }
+
+    /**
+     * @brief Return structured status (records are linked to elements of a structure).
+     */
+    bool isStructured() const;
+
+    /**
+     * @brief Get the index of the session channel used for this item.
+     */
+    unsigned int getChannel() const { return channel; }
+
     /**
      * @brief Rebuild the node id from link info structure.
      * @param info  configuration as parsed from the EPICS database
@@ -77,6 +143,12 @@ public:
      */
     virtual bool isMonitored() const override { return !!subscription; }
 
+    /**
+     * @brief Get the subscription of the item.
+     * @return subscription, nullptr if not monitored
+     */
+    SubscriptionUaSdk *getSubscription() const { return subscription; }
+
     /**
      * @brief Return registered status.
      */
@@ -88,6 +160,18 @@ public:
      */
     void setRegisteredNodeId(const UaNodeId &id) { (*nodeid) = id; registered = true; }
 
+    /**
+     * @brief Getter for the server side id of the monitored item.
+     * @return monitored item id (0 = no monitored item)
+     */
+    OpcUa_UInt32 getMonitoredItemId() const { return monitoredItemId; }
+
+    /**
+     * @brief Setter for the server side id of the monitored item.
+     * @param id  monitored item id (0 = no monitored item)
+     */
+    void setMonitoredItemId(const OpcUa_UInt32 id) { monitoredItemId = id; }
+
     /**
      * @brief Getter that returns the node id of this item.
      * @return node id
@@ -119,18 +203,35 @@ public:
     const UaStatusCode &getWriteStatus() { return writeStatus; }
 
     /**
-     * @brief Get a structure definition from the session dictionary.
-     * @param dataTypeId data type of the extension object
+     * @brief Get a structure definition from the (cached) session dictionary.
+     * @param encodingTypeId encoding type of the extension object
      * @return structure definition
      */
-    UaStructureDefinition structureDefinition(const UaNodeId &dataTypeId)
-    { return session->structureDefinition(dataTypeId); }
+    UaStructureDefinition structureDefinition(const UaNodeId &encodingTypeId)
+    { return session->structureDefinition(encodingTypeId, channel); }
+
+    /**
+     * @brief Get the generation of the session's structure definitions.
+     * @return generation (changes when the cached definitions are invalidated)
+     */
+    int structureGeneration() const { return session->structureGeneration(); }
+
+    /**
+     * @brief Return true if structures should be decoded using decoding plans.
+     */
+    bool usePlannedDecoder() const { return session->usePlannedDecoder(); }
+
+    /**
+     * @brief Get the record processing executor of the session.
+     * @return executor, nullptr if the session does not use one
+     */
+    ProcessingExecutor *processingExecutor() const { return session->processingExecutor(); }
 
     /**
      * @brief Create processing requests for record(s) attached to this item.
      * See DevOpcua::DataElement::requestRecordProcessing
      */
-    void requestRecordProcessing(const ProcessReason reason) const;
+    void requestRecordProcessing(const ProcessReason reason);
 
     /**
      * @brief Get the outgoing data value.
@@ -158,9 +259,43 @@ public:
      * Called from the OPC UA client worker thread when new data is
      * received from the OPC UA session.
      *
-     * @param value  new value for this data element
+     * @param value   new value for this data element
+     * @param reason  reason for the update (incomingData = monitored, readComplete = read)
      */
-    void setIncomingData(const OpcUa_DataValue &value);
+    void setIncomingData(const OpcUa_DataValue &value, const ProcessReason reason);
+
+    /**
+     * @brief Complete a read from the last incoming data value (if recent enough).
+     *
+     * If the last incoming data value was received less than maxAge ago,
+     * it is pushed down the root element again, so that a read can be
+     * completed without a service call.
+     *
+     * @param maxAge  max. age of the cached value [ms]
+     *
+     * @return true if the read was completed from the cached value
+     */
+    bool readFromCache(const double maxAge);
+
+    /**
+     * @brief Mark a read as pending for this item.
+     *
+     * Records that share this item and request a read while another read
+     * is pending are completed by the pending read's result.
+     *
+     * @return true if the read was marked pending, false if a read was already pending
+     */
+    bool markReadPending() { return !epics::atomic::compareAndSwap(readPending, 0, 1); }
+
+    /**
+     * @brief Clear the pending read flag (before the read's result is delivered).
+     */
+    void clearReadPending() { epics::atomic::set(readPending, 0); }
+
+    /**
+     * @brief Invalidate the last incoming data value (e.g. on connection loss).
+     */
+    void invalidateCache() { Guard G(cacheLock); hasLastValue = false; }
 
     /**
      * @brief Convert OPC UA time stamp to EPICS time stamp.
@@ -177,15 +312,40 @@ public:
     int debug() const;
 
 private:
+    /**
+     * @brief Set time stamps and status, push data value down the root element.
+     * @param value   new value for this item
+     * @param reason  reason for the update
+     */
+    void pushIncomingData(const OpcUa_DataValue &value, const ProcessReason reason);
+
     SubscriptionUaSdk *subscription;   /**< raw pointer to subscription (if monitored) */
     SessionUaSdk *session;             /**< raw pointer to session */
+    unsigned int channel;              /**< session channel used for this item */
     std::unique_ptr<UaNodeId> nodeid;  /**< node id of this item */
     bool registered;                   /**< flag for registration status */
+    OpcUa_UInt32 monitoredItemId;      /**< server side id of the monitored item */
     std::weak_ptr<DataElementUaSdk> rootElement;  /**< top level data element */
+    /** additional top level leaf elements (records sharing a scalar item) */
+    std::vector<std::weak_ptr<DataElementUaSdk>> rootLeaves;
+    /** flat element tree (breadth first, top level elements first) */
+    std::vector<DataElementUaSdk *> elementTable;
+    unsigned int noOfRoots;            /**< number of top level elements in elementTable */
+    int frozen;                        /**< flag: element tree is frozen into elementTable */
+    epicsMutex freezeLock;             /**< lock for freezing */
+    std::string sharedKey;             /**< key in sharedItems map (if shared) */
+    unsigned int noOfLinks;            /**< number of records linked to this item */
+    static std::map<std::string, ItemUaSdk *> sharedItems;  /**< shared items, by key */
     UaStatusCode readStatus;           /**< status code of last read service */
     UaStatusCode writeStatus;          /**< status code of last write service */
     epicsTimeStamp tsServer;           /**< server time stamp */
     epicsTimeStamp tsSource;           /**< device time stamp */
+    UaDataValue lastValue;             /**< last incoming data value (if maxAge is set) */
+    epicsTime tsReceived;              /**< local time when lastValue was received */
+    bool hasLastValue;                 /**< flag: lastValue is valid */
+    int readPending;                   /**< flag: a read for this item is pending */
+    epicsMutex cacheLock;              /**< lock for lastValue */
+    epicsMutex updateLock;             /**< serializes incoming data updates (writer side) */
 };
 
 } // namespace DevOpcua
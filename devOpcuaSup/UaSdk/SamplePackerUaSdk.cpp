@@ -0,0 +1,152 @@
+/*************************************************************************\
+* Copyright (c) 2026 ITER Organization.
+* This module is distributed subject to a Software License Agreement found
+* in file LICENSE that is included with this distribution.
+\*************************************************************************/
+
+/*
+ *  Author: agent <agent@local>
+ */
+
+#include <iostream>
+#include <cstring>
+
+#include <uaarraytemplates.h>
+#include <opcua_builtintypes.h>
+
+#define epicsExportSharedSymbols
+#include "SamplePackerUaSdk.h"
+
+namespace DevOpcua {
+
+// Size of a sample of a packable type (0 = type can not be packed)
+static size_t
+sampleSize (const OpcUa_BuiltInType type)
+{
+    switch (type) {
+    case OpcUaType_SByte:
+    case OpcUaType_Byte:
+        return 1;
+    case OpcUaType_Int16:
+    case OpcUaType_UInt16:
+        return 2;
+    case OpcUaType_Int32:
+    case OpcUaType_UInt32:
+    case OpcUaType_Float:
+        return 4;
+    case OpcUaType_Int64:
+    case OpcUaType_UInt64:
+    case OpcUaType_Double:
+        return 8;
+    default:
+        return 0;
+    }
+}
+
+SamplePackerUaSdk::SamplePackerUaSdk (const epicsUInt32 samples, const bool timestamps)
+    : capacity(samples ? samples : 1)
+    , timestamps(timestamps)
+    , buffer(capacity * sizeof(OpcUa_Double))
+    , type(OpcUaType_Null)
+    , valueType(OpcUaType_Null)
+    , count(0)
+    , block(0)
+    , first()
+    , blocks(0)
+    , rejected(0)
+{}
+
+template<typename T>
+void
+SamplePackerUaSdk::put (const T value)
+{
+    std::memcpy(&buffer[count * sizeof(T)], &value, sizeof(T));
+}
+
+bool
+SamplePackerUaSdk::add (const UaVariant &value, const epicsTimeStamp &ts)
+{
+    if (isFull())
+        return false;
+
+    // Time stamp mode rejects the same samples, keeping the blocks aligned
+    // with those of a companion record that packs the values
+    if (value.isArray() || !sampleSize(value.type())
+            || (count > 0 && value.type() != valueType)) {
+        rejected++;
+        return false;
+    }
+    valueType = value.type();
+    if (count == 0)
+        first = ts;
+
+    if (timestamps) {
+        type = OpcUaType_Double;
+        put<OpcUa_Double>(epicsTime(ts) - epicsTime(first));
+        count++;
+        return true;
+    }
+    type = valueType;
+
+    switch (type) {
+    case OpcUaType_SByte:  { OpcUa_SByte v;  value.toSByte(v);  put(v); break; }
+    case OpcUaType_Byte:   { OpcUa_Byte v;   value.toByte(v);   put(v); break; }
+    case OpcUaType_Int16:  { OpcUa_Int16 v;  value.toInt16(v);  put(v); break; }
+    case OpcUaType_UInt16: { OpcUa_UInt16 v; value.toUInt16(v); put(v); break; }
+    case OpcUaType_Int32:  { OpcUa_Int32 v;  value.toInt32(v);  put(v); break; }
+    case OpcUaType_UInt32: { OpcUa_UInt32 v; value.toUInt32(v); put(v); break; }
+    case OpcUaType_Int64:  { OpcUa_Int64 v;  value.toInt64(v);  put(v); break; }
+    case OpcUaType_UInt64: { OpcUa_UInt64 v; value.toUInt64(v); put(v); break; }
+    case OpcUaType_Float:  { OpcUa_Float v;  value.toFloat(v);  put(v); break; }
+    case OpcUaType_Double: { OpcUa_Double v; value.toDouble(v); put(v); break; }
+    default: break;
+    }
+    count++;
+    return true;
+}
+
+template<typename ARR, typename T>
+void
+SamplePackerUaSdk::setArray (UaVariant &array, void (UaVariant::*set)(ARR &, OpcUa_Boolean)) const
+{
+    ARR arr(static_cast<OpcUa_Int32>(count),
+            reinterpret_cast<T *>(const_cast<epicsUInt8 *>(buffer.data())));
+    (array.*set)(arr, OpcUa_True);
+}
+
+void
+SamplePackerUaSdk::take (UaVariant &array)
+{
+    switch (type) {
+    case OpcUaType_SByte:  setArray<UaSByteArray, OpcUa_SByte>(array, &UaVariant::setSByteArray); break;
+    case OpcUaType_Byte:
+    {
+        UaByteArray arr(reinterpret_cast<const char *>(buffer.data()), static_cast<int>(count));
+        array.setByteArray(arr, OpcUa_True);
+        break;
+    }
+    case OpcUaType_Int16:  setArray<UaInt16Array, OpcUa_Int16>(array, &UaVariant::setInt16Array); break;
+    case OpcUaType_UInt16: setArray<UaUInt16Array, OpcUa_UInt16>(array, &UaVariant::setUInt16Array); break;
+    case OpcUaType_Int32:  setArray<UaInt32Array, OpcUa_Int32>(array, &UaVariant::setInt32Array); break;
+    case OpcUaType_UInt32: setArray<UaUInt32Array, OpcUa_UInt32>(array, &UaVariant::setUInt32Array); break;
+    case OpcUaType_Int64:  setArray<UaInt64Array, OpcUa_Int64>(array, &UaVariant::setInt64Array); break;
+    case OpcUaType_UInt64: setArray<UaUInt64Array, OpcUa_UInt64>(array, &UaVariant::setUInt64Array); break;
+    case OpcUaType_Float:  setArray<UaFloatArray, OpcUa_Float>(array, &UaVariant::setFloatArray); break;
+    case OpcUaType_Double: setArray<UaDoubleArray, OpcUa_Double>(array, &UaVariant::setDoubleArray); break;
+    default: array.clear(); break;
+    }
+    count = 0;
+    block++;
+    blocks++;
+}
+
+void
+SamplePackerUaSdk::show () const
+{
+    std::cout << " pack=" << count << "/" << capacity
+              << (timestamps ? "(timestamps)" : "")
+              << " blocks=" << blocks
+              << " rejected=" << rejected;
+}
+
+} // namespace DevOpcua
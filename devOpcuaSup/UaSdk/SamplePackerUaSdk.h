@@ -0,0 +1,111 @@
+/*************************************************************************\
+* Copyright (c) 2026 ITER Organization.
+* This module is distributed subject to a Software License Agreement found
+* in file LICENSE that is included with this distribution.
+\*************************************************************************/
+
+/*
+ *  Author: agent <agent@local>
+ */
+
+#ifndef DEVOPCUA_SAMPLEPACKERUASDK_H
+#define DEVOPCUA_SAMPLEPACKERUASDK_H
+
+#include <vector>
+
+#include <uabase.h>
+#include <uavariant.h>
+
+#include <epicsTime.h>
+#include <epicsTypes.h>
+
+namespace DevOpcua {
+
+/**
+ * @brief Packs a stream of scalar samples into blocks (arrays).
+ *
+ * Samples are copied into a buffer that is preallocated for a full block.
+ * All samples of a block must have the same (numeric) type, the type of
+ * the first sample defines the type of the block.
+ *
+ * In time stamp mode, the block holds the time of each sample relative to
+ * the first sample of the block [s] (OpcUa_Double), instead of the values.
+ * The same samples are rejected in both modes, so that a time stamp record
+ * and a value record linked to the same item with the same pack/packtime
+ * settings get aligned blocks, as long as both are I/O Intr scanned
+ * (a read completes the current block of the reading record only).
+ */
+class SamplePackerUaSdk
+{
+public:
+    /**
+     * @brief Constructor.
+     *
+     * @param samples     number of samples in a full block
+     * @param timestamps  pack the samples' time stamps instead of their values
+     */
+    SamplePackerUaSdk(const epicsUInt32 samples, const bool timestamps);
+
+    /**
+     * @brief Add a sample to the current block.
+     *
+     * @param value  sample value (must be a numeric scalar)
+     * @param ts     sample time stamp
+     *
+     * @return false if the sample was rejected (not a numeric scalar or wrong type)
+     */
+    bool add(const UaVariant &value, const epicsTimeStamp &ts);
+
+    /**
+     * @brief Return true if the current block is complete.
+     */
+    bool isFull() const { return count >= capacity; }
+
+    /**
+     * @brief Return true if the current block has no samples.
+     */
+    bool isEmpty() const { return count == 0; }
+
+    /**
+     * @brief Get the sequence number of the current block.
+     */
+    epicsUInt32 currentBlock() const { return block; }
+
+    /**
+     * @brief Get the time stamp of the first sample of the current block.
+     */
+    const epicsTimeStamp &firstTimeStamp() const { return first; }
+
+    /**
+     * @brief Take the current block and start the next one.
+     *
+     * @param array  [out] samples of the block as an array
+     */
+    void take(UaVariant &array);
+
+    /**
+     * @brief Print statistics on stdout.
+     */
+    void show() const;
+
+private:
+    template<typename T>
+    void put(const T value);
+    template<typename ARR, typename T>
+    void setArray(UaVariant &array, void (UaVariant::*set)(ARR &, OpcUa_Boolean)) const;
+
+    const epicsUInt32 capacity;       /**< number of samples in a full block */
+    const bool timestamps;            /**< pack time stamps (instead of values) */
+    std::vector<epicsUInt8> buffer;   /**< samples of the current block (preallocated) */
+    OpcUa_BuiltInType type;           /**< type of the current block */
+    OpcUa_BuiltInType valueType;      /**< type of the samples in the current block */
+    epicsUInt32 count;                /**< number of samples in the current block */
+    epicsUInt32 block;                /**< sequence number of the current block */
+    epicsTimeStamp first;             /**< time stamp of the first sample */
+    unsigned long blocks;             /**< number of delivered blocks */
+    unsigned long rejected;           /**< number of rejected samples */
+};
+
+} // namespace DevOpcua
+
+#endif // DEVOPCUA_SAMPLEPACKERUASDK_H
@@ -60,9 +60,20 @@ void
 Session::showOptionHelp ()
 {
     std::cout << "Options:\n"
-              << "clientcert   path to client certificate [none]\n"
-              << "clientkey    path to client private key [none]\n"
-              << "batch-nodes  max. nodes per service call [0 = no limit]"
+              << "clientcert    path to client certificate [none]\n"
+              << "clientkey     path to client private key [none]\n"
+              << "batch-nodes   max. nodes per service call [0 = no limit]\n"
+              << "ops-overflow  policy if too many operations are outstanding [reject|wait]\n"
+              << "ops-timeout   timeout for outstanding read/write operations [10 s; 0 = none]\n"
+              << "ops-window    max. read/write service calls in flight [0 = no limit]\n"
+              << "chunk-window  max. chunks of a bulk (connect) service in flight [4]\n"
+              << "channels      number of low level sessions (connections) to use [1]\n"
+              << "decoder       decoder for structured data [plan|generic]\n"
+              << "batch-scan    process I/O Intr records in batches per notification [n|y]\n"
+              << "executor      worker threads processing records [0 = EPICS callback queues]\n"
+              << "exec-prio     EPICS priority of the executor threads [50]\n"
+              << "dec-threads   threads processing data changes [0 = SDK callback thread]\n"
+              << "dec-prio      EPICS priority of the decoder threads [50]"
               << std::endl;
 }
 
@@ -19,10 +19,12 @@
 #include <iostream>
 #include <string>
 #include <map>
+#include <set>
 #include <algorithm>
 #include <utility>
 #include <vector>
 #include <limits>
+#include <functional>
 
 #include <uaclientsdk.h>
 #include <uasession.h>
@@ -30,6 +32,7 @@
 #include <epicsExit.h>
 #include <epicsThread.h>
 #include <epicsAtomic.h>
+#include <epicsTime.h>
 #include <initHooks.h>
 #include <errlog.h>
 
@@ -37,6 +40,7 @@
 #include "Session.h"
 #include "RecordConnector.h"
 #include "SessionUaSdk.h"
+#include "ChannelUaSdk.h"
 #include "SubscriptionUaSdk.h"
 #include "DataElementUaSdk.h"
 #include "ItemUaSdk.h"
@@ -48,6 +52,9 @@ using namespace UaClientSdk;
 static epicsThreadOnceId session_uasdk_ihooks_once = EPICS_THREAD_ONCE_INIT;
 static epicsThreadOnceId session_uasdk_atexit_once = EPICS_THREAD_ONCE_INIT;
 
+// Default timeout for outstanding read/write operations [s]
+static const double defaultOpsTimeout = 10.0;
+
 std::map<std::string, SessionUaSdk*> SessionUaSdk::sessions;
 
 static
@@ -86,9 +93,31 @@ SessionUaSdk::SessionUaSdk (const std::string &name, const std::string &serverUr
     , serverURL(serverUrl.c_str())
     , autoConnect(autoConnect)
     , registeredItemsNo(0)
-    , puasession(new UaSession())
-    , serverConnectionStatus(UaClient::Disconnected)
     , transactionId(0)
+    , opsOverflowWait(false)
+    , opsOverflows(0)
+    , opsWindow(0)
+    , chunkWindow(4)
+    , opsTimeout(defaultOpsTimeout)
+    , opsExpired(0)
+    , deadlines(std::string("OPCtm-") + name, *this, 0.1, false)
+    , sampleDeadlines(std::string("OPCsm-") + name, *this, 0.01, false)
+    , connectQueue(std::string("OPCcn-") + name, *this, 0, false)
+    , setupPool(nullptr)
+    , structureLookups(0)
+    , definitionsGeneration(0)
+    , plannedDecoder(true)
+    , batchScan(false)
+    , executorThreads(0)
+    , executorPriority(epicsThreadPriorityMedium)
+    , decoderThreads(0)
+    , decoderPriority(epicsThreadPriorityMedium)
+    , decoderPool(nullptr)
+    , readQueue(std::string("OPCrd-") + name, *this, batchNodes, false)
+    , writeQueue(std::string("OPCwr-") + name, *this, batchNodes, false)
+    , writesCoalesced(0)
+    , readsCached(0)
+    , readsSaved(0)
 {
     int status;
     char host[256] = { 0 };
@@ -111,7 +140,14 @@ SessionUaSdk::SessionUaSdk (const std::string &name, const std::string &serverUr
             || (clientPrivateKey && (clientPrivateKey[0] != '\0')))
         errlogPrintf("OPC UA security not supported yet\n");
 
+    channels.emplace_back(new ChannelUaSdk(*this, 0));
+    connectTimings.resize(channels.size());
+
     sessions[name] = this;
+    readQueue.start();
+    writeQueue.start();
+    deadlines.startWorker();
+    connectQueue.start();
     epicsThreadOnce(&DevOpcua::session_uasdk_ihooks_once, &DevOpcua::session_uasdk_ihooks_register, nullptr);
 }
 
@@ -127,6 +163,146 @@ SessionUaSdk::getTransactionId ()
     return static_cast<OpcUa_UInt32>(epics::atomic::increment(transactionId));
 }
 
+void
+SessionUaSdk::releaseTransaction (const OpcUa_UInt32 id)
+{
+    outstandingOps.release(id);
+    if (opsWindow)
+        opsDone.signal();
+}
+
+std::vector<ItemUaSdk *> *
+SessionUaSdk::reserveTransaction (OpcUa_UInt32 &id, const ChannelUaSdk &channel)
+{
+    while (opsWindow && outstandingOps.inFlight() >= static_cast<int>(opsWindow) && channel.isConnected())
+        opsDone.wait(0.1);
+    while (true) {
+        for (epicsUInt32 n = 0; n < outstandingOps.capacity(); n++) {
+            id = getTransactionId();
+            std::vector<ItemUaSdk *> *slot = outstandingOps.reserve(id);
+            if (slot)
+                return slot;
+        }
+        epics::atomic::increment(opsOverflows);
+        if (!opsOverflowWait || !channel.isConnected())
+            return nullptr;
+        epicsThreadSleep(0.01);
+    }
+}
+
+// Tag of an outstanding operation in the transaction table
+static epicsUInt32
+opsTag (const unsigned int channel, const bool write)
+{
+    return (channel << 1) | (write ? 1 : 0);
+}
+
+void
+SessionUaSdk::activateTransaction (const OpcUa_UInt32 id, const bool write, const unsigned int channel)
+{
+    outstandingOps.activate(id, opsTag(channel, write));
+    if (opsTimeout > 0.0)
+        deadlines.add(opsTimeout, OpDeadline{id, write});
+}
+
+void
+SessionUaSdk::failOutstandingOps (const unsigned int channel, const OpcUa_StatusCode status)
+{
+    std::vector<epicsUInt32> ids;
+    for (const bool write : { false, true }) {
+        outstandingOps.activeIds(opsTag(channel, write), ids);
+        for (auto id : ids) {
+            std::vector<ItemUaSdk *> *ops = outstandingOps.claim(id);
+            if (!ops)
+                continue;   // completed in the meantime
+            for (auto item : *ops) {
+                if (write) {
+                    item->setWriteStatus(status);
+                    item->requestRecordProcessing(ProcessReason::writeComplete);
+                } else {
+                    item->clearReadPending();
+                    item->setReadStatus(status);
+                    item->requestRecordProcessing(ProcessReason::readComplete);
+                }
+            }
+            releaseTransaction(id);
+        }
+    }
+}
+
+OpcUa_UInt32
+SessionUaSdk::chunkSize (const OpcUa_UInt32 serverLimit) const
+{
+    OpcUa_UInt32 batchNodes = connectInfo.nMaxOperationsPerServiceCall;
+    if (!serverLimit)
+        return batchNodes;
+    if (!batchNodes)
+        return serverLimit;
+    return std::min(serverLimit, batchNodes);
+}
+
+namespace {
+struct ChunkRun {
+    const std::function<void(size_t, OpcUa_UInt32)> *fn;
+    size_t total;
+    size_t chunk;
+    int next;                  /**< index of the next chunk to run */
+};
+}
+
+// Take chunks until all are taken
+static void
+runChunks (ChunkRun &run)
+{
+    size_t first;
+    while ((first = static_cast<size_t>(epics::atomic::increment(run.next) - 1) * run.chunk) < run.total)
+        (*run.fn)(first, static_cast<OpcUa_UInt32>(std::min(run.chunk, run.total - first)));
+}
+
+static void
+chunkJob (void *arg, epicsJobMode mode)
+{
+    if (mode == epicsJobModeRun)
+        runChunks(*static_cast<ChunkRun *>(arg));
+}
+
+void
+SessionUaSdk::forEachChunk (const size_t total, const size_t chunk,
+                            const std::function<void(size_t, OpcUa_UInt32)> &fn)
+{
+    if (!total)
+        return;
+    ChunkRun run = { &fn, total, (chunk && chunk < total) ? chunk : total, 0 };
+    size_t noOfChunks = (total + run.chunk - 1) / run.chunk;
+    unsigned int helpers = static_cast<unsigned int>(std::min<size_t>(chunkWindow, noOfChunks)) - 1;
+    epicsThreadPool *pool = nullptr;
+    std::vector<epicsJob *> jobs;
+
+    // The calling thread runs chunks as well: the pool adds the rest of the window
+    if (helpers) {
+        epicsThreadPoolConfig opts;
+        epicsThreadPoolConfigDefaults(&opts);
+        opts.initialThreads = opts.maxThreads = helpers;
+        pool = epicsThreadPoolCreate(&opts);
+    }
+    if (pool) {
+        for (unsigned int i = 0; i < helpers; i++) {
+            epicsJob *job = epicsJobCreate(pool, chunkJob, &run);
+            if (job && !epicsJobQueue(job))
+                jobs.push_back(job);
+            else if (job)
+                epicsJobDestroy(job);
+        }
+    }
+    runChunks(run);
+    if (pool) {
+        epicsThreadPoolWait(pool, -1.0);
+        for (auto job : jobs)
+            epicsJobDestroy(job);
+        epicsThreadPoolDestroy(pool);
+    }
+}
+
 SessionUaSdk &
 SessionUaSdk::findSession (const std::string &name)
 {
@@ -144,6 +320,132 @@ SessionUaSdk::sessionExists (const std::string &name)
     return !(it == sessions.end());
 }
 
+ProcessingExecutor *
+SessionUaSdk::processingExecutor ()
+{
+    if (!executor && executorThreads)
+        executor.reset(new ProcessingExecutor(std::string("OPCex-") + name, executorThreads,
+                                              executorPriority));
+    return executor.get();
+}
+
+void
+SessionUaSdk::startDecoders ()
+{
+    if (decoderPool || !decoderThreads || subscriptions.empty())
+        return;
+
+    epicsThreadPoolConfig opts;
+    epicsThreadPoolConfigDefaults(&opts);
+    opts.initialThreads = opts.maxThreads = decoderThreads;
+    opts.workerPriority = decoderPriority;
+    decoderPool = epicsThreadPoolCreate(&opts);
+    if (!decoderPool) {
+        errlogPrintf("OPC UA session %s: cannot create decoder pool - decoding in dataChange\n",
+                     name.c_str());
+        return;
+    }
+    for (auto &it : subscriptions)
+        it.second->useDecoderPool(decoderPool);
+}
+
+UaStructureDefinition
+SessionUaSdk::structureDefinition (const UaNodeId &encodingTypeId, const unsigned int channel)
+{
+    {
+        Guard G(structurelock);
+        auto it = structureDefinitions.find(encodingTypeId);
+        if (it != structureDefinitions.end())
+            return it->second;
+    }
+    epics::atomic::increment(structureLookups);
+    UaStructureDefinition definition = channels[channel]->getUaSession()->structureDefinition(encodingTypeId);
+    if (!definition.isNull()) {
+        Guard G(structurelock);
+        structureDefinitions[encodingTypeId] = definition;
+    }
+    return definition;
+}
+
+void
+SessionUaSdk::prepareStructureDefinitions (const unsigned int channel)
+{
+    std::vector<ItemUaSdk *> structuredItems;
+    std::map<UaNodeId, bool> dataTypes;
+    epicsMutex dataTypesLock;
+
+    for (auto &it : items) {
+        if (it->getChannel() == channel && it->isStructured())
+            structuredItems.push_back(it);
+    }
+
+    // Split into chunks that comply with the server's operation limits
+    forEachChunk(structuredItems.size(), chunkSize(operationLimits.maxNodesPerRead),
+                 [&](size_t first, OpcUa_UInt32 n) {
+        UaStatus status;
+        ServiceSettings serviceSettings;
+        UaReadValueIds nodesToRead;
+        UaDataValues values;
+        UaDiagnosticInfos diagnosticInfos;
+
+        nodesToRead.create(n);
+        for (OpcUa_UInt32 i = 0; i < n; i++) {
+            structuredItems[first + i]->getNodeId().copyTo(&nodesToRead[i].NodeId);
+            nodesToRead[i].AttributeId = OpcUa_Attributes_DataType;
+        }
+
+        status = channels[channel]->getUaSession()->read(
+                    serviceSettings,                   // Use default settings
+                    0,                                 // Max age
+                    OpcUa_TimestampsToReturn_Neither,  // Time stamps to return
+                    nodesToRead,                       // Array of nodes to read
+                    values,                            // Returns an array of values
+                    diagnosticInfos);                  // Returns an array of diagnostic info
+
+        if (status.isBad()) {
+            errlogPrintf("OPC UA session %s: (prepareStructureDefinitions) read service failed with status %s\n",
+                         name.c_str(), status.toString().toUtf8());
+            return;
+        }
+        Guard G(dataTypesLock);
+        for (OpcUa_UInt32 i = 0; i < n && i < values.length(); i++) {
+            UaNodeId dataTypeId;
+            if (OpcUa_IsGood(values[i].StatusCode)
+                    && OpcUa_IsGood(UaVariant(values[i].Value).toNodeId(dataTypeId)))
+                dataTypes[dataTypeId] = true;
+        }
+    });
+
+    unsigned int prepared = 0;
+    for (auto &it : dataTypes) {
+        UaStructureDefinition definition = channels[channel]->getUaSession()->structureDefinition(it.first);
+        if (definition.isNull())
+            continue;
+        Guard G(structurelock);
+        structureDefinitions[definition.binaryEncodingId()] = definition;
+        prepared++;
+    }
+
+    if (debug)
+        std::cout << "OPC UA session " << name.c_str()
+                  << ": (prepareStructureDefinitions) cached " << prepared
+                  << " structure definitions for " << structuredItems.size()
+                  << " structured items" << std::endl;
+}
+
+unsigned int
+SessionUaSdk::channelForSubscription (const std::string &subscription) const
+{
+    return static_cast<unsigned int>(std::hash<std::string>()(subscription) % channels.size());
+}
+
+unsigned int
+SessionUaSdk::channelForNode (const UaNodeId &nodeId) const
+{
+    return static_cast<unsigned int>(
+                std::hash<std::string>()(nodeId.toXmlString().toUtf8()) % channels.size());
+}
+
 void
 SessionUaSdk::setOption (const std::string &name, const std::string &value)
 {
@@ -154,6 +456,79 @@ SessionUaSdk::setOption (const std::string &name, const std::string &value)
     } else if (name == "batch-nodes") {
         unsigned long ul = std::strtoul(value.c_str(), nullptr, 0);
         connectInfo.nMaxOperationsPerServiceCall = ul;
+        readQueue.setMaxRequestsPerBatch(chunkSize(operationLimits.maxNodesPerRead));
+        writeQueue.setMaxRequestsPerBatch(chunkSize(operationLimits.maxNodesPerWrite));
+    } else if (name == "ops-overflow") {
+        if (value == "wait") {
+            opsOverflowWait = true;
+        } else if (value == "reject") {
+            opsOverflowWait = false;
+        } else {
+            errlogPrintf("invalid value '%s' for option 'ops-overflow' ignored\n", value.c_str());
+        }
+    } else if (name == "ops-window") {
+        opsWindow = std::strtoul(value.c_str(), nullptr, 0);
+    } else if (name == "chunk-window") {
+        unsigned long ul = std::strtoul(value.c_str(), nullptr, 0);
+        if (ul < 1)
+            errlogPrintf("invalid value '%s' for option 'chunk-window' ignored\n", value.c_str());
+        else
+            chunkWindow = ul;
+    } else if (name == "ops-timeout") {
+        opsTimeout = std::strtod(value.c_str(), nullptr);
+    } else if (name == "decoder") {
+        if (value == "plan") {
+            plannedDecoder = true;
+        } else if (value == "generic") {
+            plannedDecoder = false;
+        } else {
+            errlogPrintf("invalid value '%s' for option 'decoder' ignored\n", value.c_str());
+        }
+    } else if (name == "batch-scan") {
+        if (value == "y") {
+            batchScan = true;
+        } else if (value == "n") {
+            batchScan = false;
+        } else {
+            errlogPrintf("invalid value '%s' for option 'batch-scan' ignored\n", value.c_str());
+        }
+    } else if (name == "executor" || name == "exec-prio") {
+        unsigned long ul = std::strtoul(value.c_str(), nullptr, 0);
+        if (executor) {
+            errlogPrintf("option '%s' must be set before creating records - ignored\n",
+                         name.c_str());
+        } else if (name == "executor") {
+            executorThreads = ul;
+        } else if (ul > epicsThreadPriorityMax) {
+            errlogPrintf("invalid value '%s' for option 'exec-prio' ignored\n", value.c_str());
+        } else {
+            executorPriority = ul;
+        }
+    } else if (name == "dec-threads" || name == "dec-prio") {
+        unsigned long ul = std::strtoul(value.c_str(), nullptr, 0);
+        if (decoderPool) {
+            errlogPrintf("option '%s' must be set before iocInit - ignored\n", name.c_str());
+        } else if (name == "dec-threads") {
+            decoderThreads = ul;
+        } else if (ul > epicsThreadPriorityMax) {
+            errlogPrintf("invalid value '%s' for option 'dec-prio' ignored\n", value.c_str());
+        } else {
+            decoderPriority = ul;
+        }
+    } else if (name == "channels") {
+        unsigned long ul = std::strtoul(value.c_str(), nullptr, 0);
+        if (ul < 1) {
+            errlogPrintf("invalid value '%s' for option 'channels' ignored\n", value.c_str());
+        } else if (items.size() || subscriptions.size() || isConnected()) {
+            errlogPrintf("option 'channels' must be set before creating subscriptions "
+                         "or records - ignored\n");
+        } else {
+            channels.clear();
+            for (unsigned int i = 0; i < ul; i++)
+                channels.emplace_back(new ChannelUaSdk(*this, i));
+            Guard G(timingslock);
+            connectTimings.assign(channels.size(), ConnectTimings());
+        }
     } else {
         errlogPrintf("unknown option '%s' ignored\n", name.c_str());
     }
@@ -162,247 +537,570 @@ SessionUaSdk::setOption (const std::string &name, const std::string &value)
 long
 SessionUaSdk::connect ()
 {
-    if (!puasession) {
-        std::cerr << "OPC UA session " << name.c_str()
-                  << ": invalid session, cannot connect" << std::endl;
-        return -1;
-    }
     if (isConnected()) {
         if (debug) std::cerr << "OPC UA session " << name.c_str() << ": already connected ("
-                             << serverStatusString(serverConnectionStatus) << ")" << std::endl;
+                             << serverStatusString(channels[0]->getServerStatus()) << ")" << std::endl;
         return 0;
     } else {
-        UaStatus result = puasession->connect(serverURL,      // URL of the Endpoint
-                                              connectInfo,    // General connection settings
-                                              securityInfo,   // Security settings
-                                              this);          // Callback interface
-
-        if (result.isGood()) {
-            if (debug) std::cerr << "OPC UA session " << name.c_str()
-                                 << ": connect service ok" << std::endl;
-        } else {
-            std::cerr << "OPC UA session " << name.c_str()
-                      << ": connect service failed with status "
-                      << result.toString().toUtf8() << std::endl;
+        long failed = 0;
+        for (auto &channel : channels) {
+            if (channel->isConnected())
+                continue;
+            // Additional channels get their own (distinguishable) session names
+            if (channel->getIndex())
+                connectInfo.sSessionName = UaString((name + "-" + std::to_string(channel->getIndex())).c_str());
+            else
+                connectInfo.sSessionName = UaString(name.c_str());
+
+            UaStatus result = channel->connect(serverURL, connectInfo, securityInfo);
+
+            if (result.isGood()) {
+                if (debug) std::cerr << "OPC UA session " << name.c_str()
+                                     << ": connect service ok";
+                if (debug && channels.size() > 1) std::cerr << " (channel " << channel->getIndex() << ")";
+                if (debug) std::cerr << std::endl;
+            } else {
+                std::cerr << "OPC UA session " << name.c_str()
+                          << ": connect service failed with status "
+                          << result.toString().toUtf8();
+                if (channels.size() > 1) std::cerr << " (channel " << channel->getIndex() << ")";
+                std::cerr << std::endl;
+                failed = 1;
+            }
         }
+        connectInfo.sSessionName = UaString(name.c_str());
         // asynchronous: remaining actions are done on the status-change callback
-        return !result.isGood();
+        return failed;
     }
 }
 
 long
 SessionUaSdk::disconnect ()
 {
-    if (isConnected()) {
-        ServiceSettings serviceSettings;
+    bool wasConnected = false;
+    long failed = 0;
 
-        UaStatus result = puasession->disconnect(serviceSettings,  // Use default settings
-                                                 OpcUa_True);      // Delete subscriptions
+    for (auto &channel : channels) {
+        if (!channel->isConnected())
+            continue;
+        wasConnected = true;
+
+        UaStatus result = channel->disconnect();
 
         if (result.isGood()) {
             if (debug) std::cerr << "OPC UA session " << name.c_str()
-                                 << ": disconnect service ok" << std::endl;
+                                 << ": disconnect service ok";
+            if (debug && channels.size() > 1) std::cerr << " (channel " << channel->getIndex() << ")";
+            if (debug) std::cerr << std::endl;
         } else {
             std::cerr << "OPC UA session " << name.c_str()
                       << ": disconnect service failed with status "
-                      << result.toString().toUtf8() << std::endl;
+                      << result.toString().toUtf8();
+            if (channels.size() > 1) std::cerr << " (channel " << channel->getIndex() << ")";
+            std::cerr << std::endl;
+            failed = 1;
         }
+    }
+
+    if (wasConnected) {
         // Detach all subscriptions of this session from driver
         for (auto &it : subscriptions) {
             it.second->clear();
         }
-        return !result.isGood();
     } else {
         if (debug) std::cerr << "OPC UA session " << name.c_str() << ": already disconnected ("
-                             << serverStatusString(serverConnectionStatus) << ")" << std::endl;
-        return 0;
+                             << serverStatusString(channels[0]->getServerStatus()) << ")" << std::endl;
     }
+    return failed;
 }
 
 bool
 SessionUaSdk::isConnected () const
 {
-    if (puasession)
-        return (!!puasession->isConnected()
-                && serverConnectionStatus != UaClient::ConnectionErrorApiReconnect);
-    else
-        return false;
+    for (auto &channel : channels) {
+        if (!channel->isConnected())
+            return false;
+    }
+    return true;
 }
 
-//TODO: Push to queue for worker thread (instead of doing an explicit request)
 void
-SessionUaSdk::readAllNodes ()
+SessionUaSdk::readAllNodes (const unsigned int channel)
 {
-    UaStatus status;
-    UaReadValueIds nodesToRead;
-    std::unique_ptr<std::vector<ItemUaSdk *>> itemsToRead(new std::vector<ItemUaSdk *>);
-    ServiceSettings serviceSettings;
-    OpcUa_UInt32 id = getTransactionId();
-
-    nodesToRead.create(static_cast<OpcUa_UInt32>(items.size()));
-    OpcUa_UInt32 i = 0;
     for (auto &it : items) {
-        it->getNodeId().copyTo(&nodesToRead[i].NodeId);
-        nodesToRead[i].AttributeId = OpcUa_Attributes_Value;
-        i++;
-        itemsToRead->push_back(it);
+        if (it->getChannel() == channel)
+            requestRead(*it);
+    }
+}
+
+void
+SessionUaSdk::requestRead (ItemUaSdk &item)
+{
+    if (item.linkinfo.maxAge > 0.0 && item.readFromCache(item.linkinfo.maxAge)) {
+        epics::atomic::increment(readsCached);
+        if (debug >= 5)
+            std::cout << "** Session " << name.c_str()
+                      << ": (requestRead) serving read for item "
+                      << item.getNodeId().toXmlString().toUtf8()
+                      << " from cached value" << std::endl;
+        item.requestRecordProcessing(ProcessReason::readComplete);
+        return;
     }
+    if (!item.markReadPending()) {
+        // A read for this item is queued or in flight: its result completes this request
+        epics::atomic::increment(readsSaved);
+        if (debug >= 5)
+            std::cout << "** Session " << name.c_str()
+                      << ": (requestRead) attaching read for item "
+                      << item.getNodeId().toXmlString().toUtf8()
+                      << " to pending read" << std::endl;
+        return;
+    }
+    std::shared_ptr<ReadRequest> cargo(new ReadRequest);
+    cargo->item = &item;
+    readQueue.pushRequest(cargo);
+}
 
-    Guard G(opslock);
-    status = puasession->beginRead(serviceSettings,                // Use default settings
-                                   0,                              // Max age
-                                   OpcUa_TimestampsToReturn_Both,  // Time stamps to return
-                                   nodesToRead,                    // Array of nodes to read
-                                   id);                            // Transaction id
+// Split a batch of requests by the channels of their items
+template<typename R>
+static std::vector<std::vector<std::shared_ptr<R>>>
+splitByChannel (std::vector<std::shared_ptr<R>> &batch, const size_t noOfChannels)
+{
+    std::vector<std::vector<std::shared_ptr<R>>> split(noOfChannels);
+    for (auto &c : batch)
+        split[c->item->getChannel()].push_back(c);
+    return split;
+}
 
-    if (status.isBad()) {
-        errlogPrintf("OPC UA session %s: (readAllNodes) beginRead service failed with status %s\n",
-                     name.c_str(), status.toString().toUtf8());
+void
+SessionUaSdk::processRequests (std::vector<std::shared_ptr<ReadRequest>> &batch)
+{
+    if (channels.size() == 1) {
+        sendReadRequests(batch, *channels[0]);
     } else {
-        if (debug)
-            std::cout << "OPC UA session " << name.c_str()
-                      << ": (readAllNodes) beginRead service ok"
-                      << " (transaction id " << id
-                      << "; retrieving " << nodesToRead.length() << " nodes)" << std::endl;
-        outstandingOps.insert(std::pair<OpcUa_UInt32, std::unique_ptr<std::vector<ItemUaSdk *>>>
-                              (id, std::move(itemsToRead)));
+        auto split = splitByChannel(batch, channels.size());
+        for (unsigned int i = 0; i < split.size(); i++) {
+            if (split[i].size())
+                sendReadRequests(split[i], *channels[i]);
+        }
     }
 }
 
-//TODO: Push to queue for worker thread (instead of doing a single item request)
 void
-SessionUaSdk::requestRead (ItemUaSdk &item)
+SessionUaSdk::sendReadRequests (std::vector<std::shared_ptr<ReadRequest>> &batch, ChannelUaSdk &channel)
 {
     UaStatus status;
     UaReadValueIds nodesToRead;
-    std::unique_ptr<std::vector<ItemUaSdk *>> itemsToRead(new std::vector<ItemUaSdk *>);
     ServiceSettings serviceSettings;
-    OpcUa_UInt32 id = getTransactionId();
+    OpcUa_UInt32 id;
+
+    std::vector<ItemUaSdk *> *itemsToRead = reserveTransaction(id, channel);
+    if (!itemsToRead) {
+        errlogPrintf("OPC UA session %s: (requestRead) too many outstanding operations - "
+                     "failing read of %lu nodes\n",
+                     name.c_str(), static_cast<unsigned long>(batch.size()));
+        for (auto &c : batch) {
+            c->item->clearReadPending();
+            c->item->setReadStatus(OpcUa_BadTooManyOperations);
+            c->item->requestRecordProcessing(ProcessReason::readComplete);
+        }
+        return;
+    }
 
-    nodesToRead.create(1);
-    item.getNodeId().copyTo(&nodesToRead[0].NodeId);
-    nodesToRead[0].AttributeId = OpcUa_Attributes_Value;
-    itemsToRead->push_back(&item);
+    nodesToRead.create(static_cast<OpcUa_UInt32>(batch.size()));
+    itemsToRead->reserve(batch.size());
+    // The server may use cached values not older than the smallest maxAge in the batch
+    double maxAge = batch.front()->item->linkinfo.maxAge;
+    OpcUa_UInt32 i = 0;
+    for (auto &c : batch) {
+        maxAge = std::min(maxAge, c->item->linkinfo.maxAge);
+        c->item->getNodeId().copyTo(&nodesToRead[i].NodeId);
+        nodesToRead[i].AttributeId = OpcUa_Attributes_Value;
+        i++;
+        itemsToRead->push_back(c->item);
+    }
 
-    Guard G(opslock);
-    status = puasession->beginRead(serviceSettings,                // Use default settings
-                                   0,                              // Max age
-                                   OpcUa_TimestampsToReturn_Both,  // Time stamps to return
-                                   nodesToRead,                    // Array of nodes to read
-                                   id);                            // Transaction id
+    activateTransaction(id, false, channel.getIndex());
+    status = channel.getUaSession()->beginRead(serviceSettings,                // Use default settings
+                                               maxAge,                         // Max age
+                                               OpcUa_TimestampsToReturn_Both,  // Time stamps to return
+                                               nodesToRead,                    // Array of nodes to read
+                                               id);                            // Transaction id
 
     if (status.isBad()) {
         errlogPrintf("OPC UA session %s: (requestRead) beginRead service failed with status %s\n",
                      name.c_str(), status.toString().toUtf8());
-        item.setReadStatus(status.code());
-        item.requestRecordProcessing(ProcessReason::readComplete);
-
+        if (outstandingOps.claim(id)) {
+            for (auto it : *itemsToRead) {
+                it->clearReadPending();
+                it->setReadStatus(status.code());
+                it->requestRecordProcessing(ProcessReason::readComplete);
+            }
+            releaseTransaction(id);
+        }
     } else {
         if (debug)
             std::cout << "Session " << name.c_str()
                       << ": (requestRead) beginRead service ok"
                       << " (transaction id " << id
-                      << "; retrieving " << nodesToRead.length() << " nodes)" << std::endl;
-        outstandingOps.insert(std::pair<OpcUa_UInt32, std::unique_ptr<std::vector<ItemUaSdk *>>>
-                              (id, std::move(itemsToRead)));
+                      << "; retrieving " << nodesToRead.length() << " nodes"
+                      << "; max age " << maxAge << " ms)" << std::endl;
     }
 }
 
-//TODO: Push to queue for worker thread (instead of doing a single item request)
 void
 SessionUaSdk::requestWrite (ItemUaSdk &item)
+{
+    Guard G(writelock);
+    auto it = pendingWrites.find(&item);
+    if (it != pendingWrites.end()) {
+        // Still queued: last value wins
+        it->second->value = item.getOutgoingData();
+        it->second->coalesced++;
+        writesCoalesced++;
+        if (debug >= 5)
+            std::cout << "** Session " << name.c_str()
+                      << ": (requestWrite) merged write for item "
+                      << item.getNodeId().toXmlString().toUtf8()
+                      << " into queued request" << std::endl;
+    } else {
+        std::shared_ptr<WriteRequest> cargo(new WriteRequest);
+        cargo->item = &item;
+        cargo->value = item.getOutgoingData();
+        cargo->coalesced = 0;
+        pendingWrites.insert({&item, cargo});
+        writeQueue.pushRequest(cargo);
+    }
+    item.clearOutgoingData();
+}
+
+void
+SessionUaSdk::processRequests (std::vector<std::shared_ptr<WriteRequest>> &batch)
+{
+    if (channels.size() == 1) {
+        sendWriteRequests(batch, *channels[0]);
+    } else {
+        auto split = splitByChannel(batch, channels.size());
+        for (unsigned int i = 0; i < split.size(); i++) {
+            if (split[i].size())
+                sendWriteRequests(split[i], *channels[i]);
+        }
+    }
+}
+
+void
+SessionUaSdk::sendWriteRequests (std::vector<std::shared_ptr<WriteRequest>> &batch, ChannelUaSdk &channel)
 {
     UaStatus status;
     UaWriteValues nodesToWrite;
-    std::unique_ptr<std::vector<ItemUaSdk *>> itemsToWrite(new std::vector<ItemUaSdk *>);
     ServiceSettings serviceSettings;
-    OpcUa_UInt32 id = getTransactionId();
+    OpcUa_UInt32 id;
+
+    std::vector<ItemUaSdk *> *itemsToWrite = reserveTransaction(id, channel);
+    if (!itemsToWrite) {
+        errlogPrintf("OPC UA session %s: (requestWrite) too many outstanding operations - "
+                     "failing write of %lu nodes\n",
+                     name.c_str(), static_cast<unsigned long>(batch.size()));
+        {
+            Guard G(writelock);
+            for (auto &c : batch)
+                pendingWrites.erase(c->item);
+        }
+        for (auto &c : batch) {
+            c->item->setWriteStatus(OpcUa_BadTooManyOperations);
+            c->item->requestRecordProcessing(ProcessReason::writeComplete);
+        }
+        return;
+    }
 
-    nodesToWrite.create(1);
-    item.getNodeId().copyTo(&nodesToWrite[0].NodeId);
-    nodesToWrite[0].AttributeId = OpcUa_Attributes_Value;
-    item.getOutgoingData().copyTo(&nodesToWrite[0].Value.Value);
-    item.clearOutgoingData();
-    itemsToWrite->push_back(&item);
+    nodesToWrite.create(static_cast<OpcUa_UInt32>(batch.size()));
+    itemsToWrite->reserve(batch.size());
+    {
+        // Take the requests out of the pending map before copying the (final) values
+        Guard G(writelock);
+        OpcUa_UInt32 i = 0;
+        for (auto &c : batch) {
+            pendingWrites.erase(c->item);
+            c->item->getNodeId().copyTo(&nodesToWrite[i].NodeId);
+            nodesToWrite[i].AttributeId = OpcUa_Attributes_Value;
+            c->value.copyTo(&nodesToWrite[i].Value.Value);
+            i++;
+            itemsToWrite->push_back(c->item);
+        }
+    }
 
-    Guard G(opslock);
-    status = puasession->beginWrite(serviceSettings,        // Use default settings
-                                    nodesToWrite,           // Array of nodes/data to write
-                                    id);                    // Transaction id
+    activateTransaction(id, true, channel.getIndex());
+    status = channel.getUaSession()->beginWrite(serviceSettings,        // Use default settings
+                                                nodesToWrite,           // Array of nodes/data to write
+                                                id);                    // Transaction id
 
     if (status.isBad()) {
         errlogPrintf("OPC UA session %s: (requestWrite) beginWrite service failed with status %s\n",
                      name.c_str(), status.toString().toUtf8());
-        item.setWriteStatus(status.code());
-        item.requestRecordProcessing(ProcessReason::writeComplete);
-
+        if (outstandingOps.claim(id)) {
+            for (auto it : *itemsToWrite) {
+                it->setWriteStatus(status.code());
+                it->requestRecordProcessing(ProcessReason::writeComplete);
+            }
+            releaseTransaction(id);
+        }
     } else {
         if (debug)
             std::cout << "Session " << name.c_str()
                       << ": (requestWrite) beginWrite service ok"
                       << " (transaction id " << id
                       << "; writing " << nodesToWrite.length() << " nodes)" << std::endl;
-        outstandingOps.insert(std::pair<OpcUa_UInt32, std::unique_ptr<std::vector<ItemUaSdk *>>>
-                              (id, std::move(itemsToWrite)));
     }
 }
 
+namespace {
+struct SetupJob {
+    SubscriptionUaSdk *subscription;
+    bool tryTransfer;
+};
+}
+
+static void
+subscriptionSetupJob (void *arg, epicsJobMode mode)
+{
+    SetupJob *setup = static_cast<SetupJob *>(arg);
+    if (mode == epicsJobModeRun)
+        setup->subscription->setup(setup->tryTransfer);
+}
+
 void
-SessionUaSdk::createAllSubscriptions ()
+SessionUaSdk::setupAllSubscriptions (const unsigned int channel, ConnectTimings &timings,
+                                     const bool tryTransfer)
 {
+    std::vector<epicsJob *> jobs;
+    std::vector<SetupJob> setups;
+
+    setups.reserve(subscriptions.size());
     for (auto &it : subscriptions) {
-        it.second->create();
+        if (it.second->getChannel() == channel)
+            setups.push_back(SetupJob{it.second, tryTransfer});
+    }
+
+    if (!setupPool && setups.size() > 1) {
+        epicsThreadPoolConfig opts;
+        epicsThreadPoolConfigDefaults(&opts);
+        opts.maxThreads = std::min(opts.maxThreads, static_cast<unsigned int>(subscriptions.size()));
+        setupPool = epicsThreadPoolCreate(&opts);
+    }
+
+    if (setupPool) {
+        for (auto &it : setups) {
+            epicsJob *job = epicsJobCreate(setupPool, subscriptionSetupJob, &it);
+            if (job && !epicsJobQueue(job)) {
+                jobs.push_back(job);
+            } else {
+                if (job)
+                    epicsJobDestroy(job);
+                it.subscription->setup(tryTransfer);
+            }
+        }
+        epicsThreadPoolWait(setupPool, -1.0);
+        for (auto job : jobs)
+            epicsJobDestroy(job);
+    } else {
+        for (auto &it : setups)
+            it.subscription->setup(tryTransfer);
+    }
+
+    timings.transferred = timings.recreated = 0;
+    for (auto &it : setups) {
+        if (it.subscription->wasTransferred())
+            timings.transferred++;
+        else
+            timings.recreated++;
     }
 }
 
 void
-SessionUaSdk::addAllMonitoredItems ()
+SessionUaSdk::processRequests (std::vector<std::shared_ptr<ConnectRequest>> &batch)
 {
-    for (auto &it : subscriptions) {
-        it.second->addMonitoredItems();
+    // Merge the requests per channel
+    std::map<unsigned int, ConnectRequest> merged;
+    for (auto &c : batch) {
+        auto it = merged.find(c->channel);
+        if (it == merged.end()) {
+            merged.insert({c->channel, *c});
+        } else {
+            it->second.setup |= c->setup;
+            it->second.read |= c->read;
+            it->second.transfer |= c->transfer;
+        }
     }
+    for (auto &it : merged)
+        runConnectPipeline(it.second);
 }
 
 void
-SessionUaSdk::registerNodes ()
+SessionUaSdk::runConnectPipeline (const ConnectRequest &request)
 {
-    UaStatus          status;
-    UaNodeIdArray     nodesToRegister;
-    UaNodeIdArray     registeredNodes;
-    ServiceSettings   serviceSettings;
+    const unsigned int channel = request.channel;
+    ConnectTimings timings;
+    {
+        // Steps that are not run keep their previous timings
+        Guard G(timingslock);
+        timings = connectTimings[channel];
+    }
+    epicsTime start = epicsTime::getCurrent();
+    epicsTime t0 = start;
+    epicsTime t1;
+
+    readOperationLimits(channel);
+    t1 = epicsTime::getCurrent();
+    timings.limits = (t1 - t0) * 1e3;
+
+    if (request.setup) {
+        t0 = t1;
+        registerNodes(channel);
+        t1 = epicsTime::getCurrent();
+        timings.registerNodes = (t1 - t0) * 1e3;
+
+        t0 = t1;
+        prepareStructureDefinitions(channel);
+        t1 = epicsTime::getCurrent();
+        timings.structures = (t1 - t0) * 1e3;
+    }
 
-    nodesToRegister.create(static_cast<OpcUa_UInt32>(items.size()));
-    OpcUa_UInt32 i = 0;
+    // Reads are asynchronous: they are sent while the subscriptions are being set up
+    if (request.read)
+        readAllNodes(channel);
+
+    if (request.setup) {
+        t0 = t1;
+        setupAllSubscriptions(channel, timings, request.transfer);
+        t1 = epicsTime::getCurrent();
+        timings.subscriptions = (t1 - t0) * 1e3;
+    }
+    timings.total = (t1 - start) * 1e3;
+    {
+        // Publish the completed run (read by show)
+        Guard G(timingslock);
+        connectTimings[channel] = timings;
+    }
+
+    if (debug)
+        std::cout << "OPC UA session " << name.c_str()
+                  << ": (connect) pipeline for channel " << channel
+                  << " done in " << timings.total << " ms"
+                  << " (limits " << timings.limits
+                  << ", register " << timings.registerNodes
+                  << ", structures " << timings.structures
+                  << ", subscriptions " << timings.subscriptions
+                  << ": " << timings.transferred << " transferred, "
+                  << timings.recreated << " created)" << std::endl;
+}
+
+void
+SessionUaSdk::registerNodes (const unsigned int channel)
+{
+    std::vector<ItemUaSdk *> itemsToRegister;
+    int registered = 0;
+
+    // A registered node id is only valid within its session: register the original ids
     for (auto &it : items) {
-        if (it->linkinfo.registerNode) {
-            it->getNodeId().copyTo(&nodesToRegister[i]);
-            i++;
+        if (it->linkinfo.registerNode && it->getChannel() == channel) {
+            itemsToRegister.push_back(it);
+            if (it->isRegistered()) {
+                registeredItemsNo--;
+                it->rebuildNodeId();
+            }
         }
     }
-    nodesToRegister.resize(i);
-    registeredItemsNo = i;
 
-    status = puasession->registerNodes(serviceSettings,     // Use default settings
-                                       nodesToRegister,     // Array of nodeIds to register
-                                       registeredNodes);    // Returns an array of registered nodeIds
+    // Split into chunks that comply with the server's operation limits
+    forEachChunk(itemsToRegister.size(), chunkSize(operationLimits.maxNodesPerRegisterNodes),
+                 [&](size_t first, OpcUa_UInt32 n) {
+        UaStatus          status;
+        UaNodeIdArray     nodesToRegister;
+        UaNodeIdArray     registeredNodes;
+        ServiceSettings   serviceSettings;
+
+        nodesToRegister.create(n);
+        for (OpcUa_UInt32 i = 0; i < n; i++)
+            itemsToRegister[first + i]->getNodeId().copyTo(&nodesToRegister[i]);
+
+        status = channels[channel]->getUaSession()->registerNodes(
+                    serviceSettings,     // Use default settings
+                    nodesToRegister,     // Array of nodeIds to register
+                    registeredNodes);    // Returns an array of registered nodeIds
+
+        if (status.isBad()) {
+            errlogPrintf("OPC UA session %s: (registerNodes) registerNodes service failed with status %s\n",
+                         name.c_str(), status.toString().toUtf8());
+        } else {
+            if (debug)
+                std::cout << "OPC UA session " << name.c_str()
+                          << ": (registerNodes) registerNodes service ok"
+                          << " (" << registeredNodes.length() << " nodes registered)" << std::endl;
+            for (OpcUa_UInt32 i = 0; i < n && i < registeredNodes.length(); i++) {
+                itemsToRegister[first + i]->setRegisteredNodeId(registeredNodes[i]);
+                epics::atomic::increment(registered);
+            }
+        }
+    });
+    registeredItemsNo += registered;
+}
 
+void
+SessionUaSdk::readOperationLimits (const unsigned int channel)
+{
+    UaStatus status;
+    ServiceSettings serviceSettings;
+    UaReadValueIds nodesToRead;
+    UaDataValues values;
+    UaDiagnosticInfos diagnosticInfos;
+    const OpcUa_UInt32 limitIds[] = {
+        OpcUaId_Server_ServerCapabilities_OperationLimits_MaxNodesPerRead,
+        OpcUaId_Server_ServerCapabilities_OperationLimits_MaxNodesPerWrite,
+        OpcUaId_Server_ServerCapabilities_OperationLimits_MaxNodesPerRegisterNodes,
+        OpcUaId_Server_ServerCapabilities_OperationLimits_MaxMonitoredItemsPerCall
+    };
+    OpcUa_UInt32 *limits[] = {
+        &operationLimits.maxNodesPerRead,
+        &operationLimits.maxNodesPerWrite,
+        &operationLimits.maxNodesPerRegisterNodes,
+        &operationLimits.maxMonitoredItemsPerCall
+    };
+    const OpcUa_UInt32 noOfLimits = sizeof(limitIds) / sizeof(limitIds[0]);
+
+    nodesToRead.create(noOfLimits);
+    for (OpcUa_UInt32 i = 0; i < noOfLimits; i++) {
+        UaNodeId(limitIds[i]).copyTo(&nodesToRead[i].NodeId);
+        nodesToRead[i].AttributeId = OpcUa_Attributes_Value;
+    }
+
+    status = channels[channel]->getUaSession()->read(
+                serviceSettings,                   // Use default settings
+                0,                                 // Max age
+                OpcUa_TimestampsToReturn_Neither,  // Time stamps to return
+                nodesToRead,                       // Array of nodes to read
+                values,                            // Returns an array of values
+                diagnosticInfos);                  // Returns an array of diagnostic info
+
+    operationLimits = OperationLimits();
     if (status.isBad()) {
-        errlogPrintf("OPC UA session %s: (registerNodes) registerNodes service failed with status %s\n",
+        errlogPrintf("OPC UA session %s: (readOperationLimits) read service failed with status %s\n",
                      name.c_str(), status.toString().toUtf8());
     } else {
+        // Servers that do not expose a limit (or have it at 0) are treated as unlimited
+        for (OpcUa_UInt32 i = 0; i < noOfLimits && i < values.length(); i++) {
+            if (OpcUa_IsGood(values[i].StatusCode))
+                UaVariant(values[i].Value).toUInt32(*limits[i]);
+        }
         if (debug)
             std::cout << "OPC UA session " << name.c_str()
-                      << ": (registerNodes) registerNodes service ok"
-                      << " (" << registeredNodes.length() << " nodes registered)" << std::endl;
-        i = 0;
-        for (auto &it : items) {
-            if (it->linkinfo.registerNode) {
-                it->setRegisteredNodeId(registeredNodes[i]);
-                i++;
-            }
-        }
-        registeredItemsNo = i;
+                      << ": (readOperationLimits) server limits"
+                      << " read=" << operationLimits.maxNodesPerRead
+                      << " write=" << operationLimits.maxNodesPerWrite
+                      << " register=" << operationLimits.maxNodesPerRegisterNodes
+                      << " monitor=" << operationLimits.maxMonitoredItemsPerCall << std::endl;
     }
+    readQueue.setMaxRequestsPerBatch(chunkSize(operationLimits.maxNodesPerRead));
+    writeQueue.setMaxRequestsPerBatch(chunkSize(operationLimits.maxNodesPerWrite));
 }
 
 void
@@ -414,10 +1112,24 @@ SessionUaSdk::rebuildNodeIds ()
 }
 
 void
-SessionUaSdk::invalidateAllNodes ()
+SessionUaSdk::invalidateAllNodes (const unsigned int channel)
 {
-    for (auto &it : items)
-        it->requestRecordProcessing(ProcessReason::connectionLoss);
+    // Responses of the lost session will not arrive: complete the waiting records
+    failOutstandingOps(channel, OpcUa_BadConnectionClosed);
+
+    std::set<SubscriptionUaSdk *> queued;
+    for (auto &it : subscriptions) {
+        if (it.second->getChannel() == channel && it.second->queueConnectionLoss())
+            queued.insert(it.second);
+    }
+    for (auto &it : items) {
+        if (it->getChannel() != channel)
+            continue;
+        it->invalidateCache();
+        // Items on a subscription using the decoder pool get it behind their pending data
+        if (!queued.count(it->getSubscription()))
+            it->requestRecordProcessing(ProcessReason::connectionLoss);
+    }
 }
 
 void
@@ -425,13 +1137,18 @@ SessionUaSdk::show (const int level) const
 {
     std::cout << "session="      << name
               << " url="         << serverURL.toUtf8()
-              << " status="      << serverStatusString(serverConnectionStatus)
+              << " status="      << serverStatusString(channels[0]->getServerStatus());
+    if (channels.size() > 1) {
+        for (unsigned int i = 1; i < channels.size(); i++)
+            std::cout << "/" << serverStatusString(channels[i]->getServerStatus());
+    }
+    std::cout << " channels="    << channels.size()
               << " cert="        << "[none]"
               << " key="         << "[none]"
               << " debug="       << debug
               << " batch=";
     if (isConnected())
-        std::cout << puasession->maxOperationsPerServiceCall();
+        std::cout << channels[0]->getUaSession()->maxOperationsPerServiceCall();
     else
         std::cout << "?";
     std::cout << "(" << connectInfo.nMaxOperationsPerServiceCall << ")"
@@ -439,7 +1156,49 @@ SessionUaSdk::show (const int level) const
               << " items=" << items.size()
               << " registered=" << registeredItemsNo
               << " subscriptions=" << subscriptions.size()
-              << std::endl;
+              << " reads=" << readQueue.requests() << "/" << readQueue.batches()
+              << "(" << readQueue.size() << " queued, "
+              << epics::atomic::get(readsCached) << " cached, "
+              << epics::atomic::get(readsSaved) << " saved)"
+              << " writes=" << writeQueue.requests() << "/" << writeQueue.batches()
+              << "(" << writeQueue.size() << " queued, " << writesCoalesced << " merged)"
+              << " limits(r/w/reg/mon)=" << operationLimits.maxNodesPerRead
+              << "/" << operationLimits.maxNodesPerWrite
+              << "/" << operationLimits.maxNodesPerRegisterNodes
+              << "/" << operationLimits.maxMonitoredItemsPerCall
+              << "(" << chunkWindow << " chunks in flight)"
+              << " inflight=" << outstandingOps.inFlight() << "/" << outstandingOps.capacity()
+              << "(window " << opsWindow << ", "
+              << epics::atomic::get(opsOverflows) << " overflows, "
+              << (opsOverflowWait ? "wait" : "reject") << ")"
+              << " timeout=" << opsTimeout
+              << "(" << epics::atomic::get(opsExpired) << " expired)";
+    std::vector<ConnectTimings> lastTimings;
+    {
+        Guard G(timingslock);
+        lastTimings = connectTimings;
+    }
+    for (unsigned int i = 0; i < lastTimings.size(); i++) {
+        const ConnectTimings &timings = lastTimings[i];
+        std::cout << " connect[" << i << "](limits/register/structures/subscriptions/total)=" << timings.limits
+                  << "/" << timings.registerNodes
+                  << "/" << timings.structures
+                  << "/" << timings.subscriptions
+                  << "/" << timings.total << "ms"
+                  << " transfers[" << i << "](transferred/created)=" << timings.transferred
+                  << "/" << timings.recreated;
+    }
+    {
+        Guard G(structurelock);
+        std::cout << " structures=" << structureDefinitions.size()
+                  << "(" << epics::atomic::get(structureLookups) << " lookups, "
+                  << (plannedDecoder ? "plan" : "generic") << " decoder)";
+    }
+    if (executor)
+        executor->show();
+    if (decoderPool)
+        std::cout << " decoders(threads/prio)=" << decoderThreads << "/" << decoderPriority;
+    std::cout << std::endl;
 
     if (level >= 1) {
         for (auto &it : subscriptions) {
@@ -471,17 +1230,22 @@ SessionUaSdk::removeItemUaSdk (ItemUaSdk *item)
         items.erase(it);
 }
 
-// UaSessionCallback interface
+// UaSessionCallback interface (forwarded by the channels)
 
 void SessionUaSdk::connectionStatusChanged (
-    OpcUa_UInt32             clientConnectionId,
+    ChannelUaSdk             &channel,
     UaClient::ServerStatus   serverStatus)
 {
-    OpcUa_ReferenceParameter(clientConnectionId);
-    errlogPrintf("OPC UA session %s: connection status changed from %s to %s\n",
-                 name.c_str(),
-                 serverStatusString(serverConnectionStatus),
-                 serverStatusString(serverStatus));
+    if (channels.size() > 1)
+        errlogPrintf("OPC UA session %s: connection status (channel %u) changed from %s to %s\n",
+                     name.c_str(), channel.getIndex(),
+                     serverStatusString(channel.getServerStatus()),
+                     serverStatusString(serverStatus));
+    else
+        errlogPrintf("OPC UA session %s: connection status changed from %s to %s\n",
+                     name.c_str(),
+                     serverStatusString(channel.getServerStatus()),
+                     serverStatusString(serverStatus));
 
     switch (serverStatus) {
 
@@ -492,7 +1256,7 @@ void SessionUaSdk::connectionStatusChanged (
     case UaClient::ServerShutdown:
         // "The connection to the server is deactivated by the user of the client API."
     case UaClient::Disconnected:
-        invalidateAllNodes();
+        invalidateAllNodes(channel.getIndex());
         break;
 
         // "The monitoring of the connection to the server indicated
@@ -502,25 +1266,38 @@ void SessionUaSdk::connectionStatusChanged (
 
         // "The connection to the server is established and is working in normal mode."
     case UaClient::Connected:
-        readAllNodes();
-        if (serverConnectionStatus == UaClient::Disconnected) {
-            registerNodes();
-            createAllSubscriptions();
-            addAllMonitoredItems();
-        }
+    {
+        std::shared_ptr<ConnectRequest> cargo(new ConnectRequest);
+        cargo->setup = (channel.getServerStatus() == UaClient::Disconnected);
+        cargo->read = true;
+        cargo->transfer = false;
+        cargo->channel = channel.getIndex();
+        connectQueue.pushRequest(cargo);
         break;
+    }
 
         // "The client was not able to reuse the old session
         // and created a new session during reconnect.
         // This requires to redo register nodes for the new session
         // or to read the namespace array."
     case UaClient::NewSessionCreated:
-        registerNodes();
-        createAllSubscriptions();
-        addAllMonitoredItems();
+    {
+        {
+            // Type dictionary has to be read again from the new session
+            Guard G(structurelock);
+            structureDefinitions.clear();
+            epics::atomic::increment(definitionsGeneration);
+        }
+        std::shared_ptr<ConnectRequest> cargo(new ConnectRequest);
+        cargo->setup = true;
+        cargo->read = false;
+        cargo->transfer = true;
+        cargo->channel = channel.getIndex();
+        connectQueue.pushRequest(cargo);
         break;
     }
-    serverConnectionStatus = serverStatus;
+    }
+    channel.setServerStatus(serverStatus);
 }
 
 void
@@ -529,9 +1306,8 @@ SessionUaSdk::readComplete (OpcUa_UInt32 transactionId,
                             const UaDataValues &values,
                             const UaDiagnosticInfos &diagnosticInfos)
 {
-    Guard G(opslock);
-    auto it = outstandingOps.find(transactionId);
-    if (it == outstandingOps.end()) {
+    std::vector<ItemUaSdk *> *ops = outstandingOps.claim(transactionId);
+    if (!ops) {
         errlogPrintf("OPC UA session %s: (readComplete) received a callback "
                      "with unknown transaction id %u - ignored\n",
                      name.c_str(), transactionId);
@@ -541,19 +1317,32 @@ SessionUaSdk::readComplete (OpcUa_UInt32 transactionId,
                       << ": (readComplete) getting data for read service"
                       << " (transaction id " << transactionId
                       << "; data for " << values.length() << " items)" << std::endl;
+        // A failed service or a short response fails the items without a value
+        OpcUa_StatusCode failure = result.isBad() ? result.statusCode() : OpcUa_BadUnexpectedError;
+        OpcUa_UInt32 valid = result.isBad() ? 0 : values.length();
+        if (valid < ops->size())
+            errlogPrintf("OPC UA session %s: (readComplete) read service returned %u of %lu values "
+                         "(status %s)\n",
+                         name.c_str(), valid, static_cast<unsigned long>(ops->size()),
+                         result.toString().toUtf8());
         OpcUa_UInt32 i = 0;
-        for (auto item : (*it->second)) {
+        for (auto item : *ops) {
             if (debug >= 5) {
                 std::cout << "** Session " << name.c_str()
                           << ": (readComplete) getting data for item "
                           << item->getNodeId().toXmlString().toUtf8() << std::endl;
             }
-            item->setReadStatus(values[i].StatusCode);
-            item->setIncomingData(values[i]);
+            item->clearReadPending();
+            if (i < valid) {
+                item->setReadStatus(values[i].StatusCode);
+                item->setIncomingData(values[i], ProcessReason::readComplete);
+            } else {
+                item->setReadStatus(failure);
+            }
             item->requestRecordProcessing(ProcessReason::readComplete);
             i++;
         }
-        outstandingOps.erase(it);
+        releaseTransaction(transactionId);
     }
 }
 
@@ -563,9 +1352,8 @@ SessionUaSdk::writeComplete (OpcUa_UInt32 transactionId,
                              const UaStatusCodeArray& results,
                              const UaDiagnosticInfos& diagnosticInfos)
 {
-    Guard G(opslock);
-    auto it = outstandingOps.find(transactionId);
-    if (it == outstandingOps.end()) {
+    std::vector<ItemUaSdk *> *ops = outstandingOps.claim(transactionId);
+    if (!ops) {
         errlogPrintf("OPC UA session %s: (writeComplete) received a callback "
                      "with unknown transaction id %u - ignored\n",
                      name.c_str(), transactionId);
@@ -575,21 +1363,69 @@ SessionUaSdk::writeComplete (OpcUa_UInt32 transactionId,
                       << ": (writeComplete) getting results for write service"
                       << " (transaction id " << transactionId
                       << "; results for " << results.length() << " items)" << std::endl;
+        // A failed service or a short response fails the items without a result
+        OpcUa_StatusCode failure = result.isBad() ? result.statusCode() : OpcUa_BadUnexpectedError;
+        OpcUa_UInt32 valid = result.isBad() ? 0 : results.length();
+        if (valid < ops->size())
+            errlogPrintf("OPC UA session %s: (writeComplete) write service returned %u of %lu results "
+                         "(status %s)\n",
+                         name.c_str(), valid, static_cast<unsigned long>(ops->size()),
+                         result.toString().toUtf8());
         OpcUa_UInt32 i = 0;
-        for (auto item : (*it->second)) {
+        for (auto item : *ops) {
             if (debug >= 5) {
                 std::cout << "** Session " << name.c_str()
                           << ": (writeComplete) getting results for item "
                           << item->getNodeId().toXmlString().toUtf8() << std::endl;
             }
-            item->setWriteStatus(results[i]);
+            item->setWriteStatus(i < valid ? results[i] : failure);
             item->requestRecordProcessing(ProcessReason::writeComplete);
             i++;
         }
-        outstandingOps.erase(it);
+        releaseTransaction(transactionId);
     }
 }
 
+void
+SessionUaSdk::timersExpired (std::vector<OpDeadline> &expired)
+{
+    for (auto &deadline : expired) {
+        std::vector<ItemUaSdk *> *ops = outstandingOps.claim(deadline.transactionId);
+        if (!ops)
+            continue;   // completed in time
+        epics::atomic::increment(opsExpired);
+        errlogPrintf("OPC UA session %s: %s operation (transaction id %u; %lu nodes) "
+                     "timed out after %g s\n",
+                     name.c_str(), deadline.write ? "write" : "read", deadline.transactionId,
+                     static_cast<unsigned long>(ops->size()), opsTimeout);
+        for (auto item : *ops) {
+            if (deadline.write) {
+                item->setWriteStatus(OpcUa_BadTimeout);
+                item->requestRecordProcessing(ProcessReason::writeComplete);
+            } else {
+                item->clearReadPending();
+                item->setReadStatus(OpcUa_BadTimeout);
+                item->requestRecordProcessing(ProcessReason::readComplete);
+            }
+        }
+        releaseTransaction(deadline.transactionId);
+    }
+}
+
+void
+SessionUaSdk::timersExpired (std::vector<SampleDeadline> &expired)
+{
+    for (auto &deadline : expired)
+        deadline.element->blockTimeout(deadline.block);
+}
+
+void
+SessionUaSdk::addSampleDeadline (const double delay, const SampleDeadline &deadline)
+{
+    sampleDeadlines.startWorker();
+    sampleDeadlines.add(delay, deadline);
+}
+
 void
 SessionUaSdk::showAll (const int level)
 {
@@ -616,19 +1452,34 @@ SessionUaSdk::showAll (const int level)
 
 SessionUaSdk::~SessionUaSdk ()
 {
-    if (puasession) {
-        if (isConnected()) {
-            ServiceSettings serviceSettings;
-            puasession->disconnect(serviceSettings, OpcUa_True);
-        }
-        delete puasession;
-    }
+    connectQueue.stop();
+    if (executor)
+        executor->stop();
+    if (setupPool)
+        epicsThreadPoolDestroy(setupPool);
+    if (decoderPool)
+        epicsThreadPoolDestroy(decoderPool);
+    readQueue.stop();
+    writeQueue.stop();
+    deadlines.stop();
+    sampleDeadlines.stop();
+    channels.clear();
 }
 
 void
 SessionUaSdk::initHook (initHookState state)
 {
     switch (state) {
+    case initHookAfterIocBuilt:
+    {
+        // All records are linked: freeze the data element trees
+        for (auto &it : sessions) {
+            for (auto &item : it.second->items)
+                item->freeze();
+            it.second->startDecoders();
+        }
+        break;
+    }
     case initHookAfterDatabaseRunning:
     {
         errlogPrintf("OPC UA: Autoconnecting sessions\n");
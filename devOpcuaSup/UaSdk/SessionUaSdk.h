@@ -16,17 +16,27 @@
 
 #include <algorithm>
 #include <vector>
+#include <map>
+#include <unordered_map>
 #include <memory>
+#include <functional>
 
 #include <uabase.h>
 #include <uaclientsdk.h>
 #include <uasession.h>
 
 #include <epicsMutex.h>
+#include <epicsEvent.h>
+#include <epicsThreadPool.h>
 #include <epicsTypes.h>
 #include <initHooks.h>
 
 #include "Session.h"
+#include "ChannelUaSdk.h"
+#include "RequestQueueBatcher.h"
+#include "TransactionTable.h"
+#include "TimerWheel.h"
+#include "ProcessingExecutor.h"
 
 namespace DevOpcua {
 
@@ -34,6 +44,75 @@ using namespace UaClientSdk;
 
 class SubscriptionUaSdk;
 class ItemUaSdk;
+class DataElementUaSdk;
+
+/**
+ * @brief A read request for a single item (queued for the session's reader thread).
+ */
+struct ReadRequest {
+    ItemUaSdk *item;
+};
+
+/**
+ * @brief A write request for a single item (queued for the session's writer thread).
+ *
+ * While the request is waiting in the queue, later writes to the same item
+ * replace the value (last value wins).
+ */
+struct WriteRequest {
+    ItemUaSdk *item;
+    UaVariant value;           /**< value to write */
+    unsigned int coalesced;    /**< number of writes merged into this request */
+};
+
+/**
+ * @brief A request to run the connect pipeline (queued for the session's connect thread).
+ */
+struct ConnectRequest {
+    bool setup;                /**< (re)create server side state: register nodes, subscriptions, monitored items */
+    bool read;                 /**< read all nodes */
+    bool transfer;             /**< try to transfer subscriptions from the previous session */
+    unsigned int channel;      /**< channel that (re)connected */
+};
+
+/**
+ * @brief Durations of the phases of the last connect pipeline run of a channel [ms].
+ */
+struct ConnectTimings {
+    double limits = 0.0;          /**< reading operation limits */
+    double registerNodes = 0.0;   /**< registering nodes */
+    double structures = 0.0;      /**< preparing structure definitions */
+    double subscriptions = 0.0;   /**< creating subscriptions and monitored items (in parallel) */
+    double total = 0.0;           /**< whole pipeline */
+    unsigned int transferred = 0; /**< number of subscriptions transferred */
+    unsigned int recreated = 0;   /**< number of subscriptions created */
+};
+
+/**
+ * @brief Operation limits of the server (0 = no limit).
+ */
+struct OperationLimits {
+    OpcUa_UInt32 maxNodesPerRead = 0;
+    OpcUa_UInt32 maxNodesPerWrite = 0;
+    OpcUa_UInt32 maxNodesPerRegisterNodes = 0;
+    OpcUa_UInt32 maxMonitoredItemsPerCall = 0;
+};
+
+/**
+ * @brief Deadline of an outstanding read or write operation (timer wheel cargo).
+ */
+struct OpDeadline {
+    OpcUa_UInt32 transactionId;
+    bool write;                /**< write (true) or read (false) operation */
+};
+
+/**
+ * @brief Time limit of a block of packed samples or an aggregation window (timer wheel cargo).
+ */
+struct SampleDeadline {
+    DataElementUaSdk *element;
+    epicsUInt32 block;         /**< sequence number of the block or window */
+};
 
 /**
  * @brief The SessionUaSdk implementation of an OPC UA client session.
@@ -47,9 +126,29 @@ class ItemUaSdk;
  *
  * The disconnect call disconnects the Session, deleting all Subscriptions
  * and freeing all related resources on both server and client.
+ *
+ * Read requests are pushed into a queue. The session's reader thread drains
+ * the queue and sends the pending reads as multi-node beginRead service calls,
+ * limited by the max. number of nodes per service call (batch-nodes option).
+ *
+ * Write requests are handled the same way by the session's writer thread.
+ * Writes for an item that already has a write request waiting in the queue
+ * are merged into that request, so that only the latest value is sent.
+ *
+ * A session may open multiple channels (low level sessions) to the server
+ * (channels option). Subscriptions are distributed over the channels by a
+ * hash of their name, items on a subscription use its channel, all other
+ * items are distributed by a hash of their node id. Batches of read and
+ * write requests are split by channel.
  */
 
-class SessionUaSdk : public UaSessionCallback, public Session
+class SessionUaSdk
+        : public Session
+        , public RequestConsumer<ReadRequest>
+        , public RequestConsumer<WriteRequest>
+        , public TimerConsumer<OpDeadline>
+        , public TimerConsumer<SampleDeadline>
+        , public RequestConsumer<ConnectRequest>
 {
     UA_DISABLE_COPY(SessionUaSdk);
     friend class SubscriptionUaSdk;
@@ -104,15 +203,85 @@ public:
 
     /**
      * @brief Get a structure definition from the session dictionary.
-     * @param dataTypeId data type of the extension object
+     *
+     * Definitions are cached by encoding type id. The cache is filled
+     * for all structured items at connect time and invalidated when
+     * the client library creates a new session.
+     *
+     * @param encodingTypeId encoding type of the extension object
+     * @param channel  channel to query on a cache miss (the item's channel)
      * @return structure definition
      */
-    UaStructureDefinition structureDefinition(const UaNodeId &dataTypeId)
-    { return puasession->structureDefinition(dataTypeId); }
+    UaStructureDefinition structureDefinition(const UaNodeId &encodingTypeId, const unsigned int channel);
+
+    /**
+     * @brief Get the generation of the cached structure definitions.
+     *
+     * Incremented whenever the cache is invalidated, so that data elements
+     * can keep their own copy of a definition.
+     *
+     * @return generation
+     */
+    int structureGeneration() const { return epics::atomic::get(definitionsGeneration); }
+
+    /**
+     * @brief Return true if structures should be decoded using decoding plans
+     * (decoder option).
+     */
+    bool usePlannedDecoder() const { return plannedDecoder; }
+
+    /**
+     * @brief Return true if I/O Intr records should be processed in batches
+     * per data change notification (batch-scan option).
+     */
+    bool useBatchScan() const { return batchScan; }
+
+    /**
+     * @brief Get the record processing executor of the session (executor option).
+     *
+     * Creates the executor on first use.
+     *
+     * @return executor, nullptr if records are processed through the EPICS callback queues
+     */
+    ProcessingExecutor *processingExecutor();
+
+    /**
+     * @brief Start the decoder thread pool (dec-threads option).
+     *
+     * Moves the processing of data change notifications of all subscriptions
+     * of the session from the SDK callback thread to the pool.
+     */
+    void startDecoders();
+
+    /**
+     * @brief Get the number of channels (low level sessions) of the session.
+     */
+    unsigned int noOfChannels() const { return static_cast<unsigned int>(channels.size()); }
+
+    /**
+     * @brief Get the channel for a subscription.
+     *
+     * @param subscription  subscription name
+     *
+     * @return channel index
+     */
+    unsigned int channelForSubscription(const std::string &subscription) const;
+
+    /**
+     * @brief Get the channel for an item that is not on a subscription.
+     *
+     * @param nodeId  node id of the item
+     *
+     * @return channel index
+     */
+    unsigned int channelForNode(const UaNodeId &nodeId) const;
 
     /**
      * @brief Request a beginRead service for an item
      *
+     * The request is pushed into the read request queue and
+     * will be sent by the reader thread (batched with other requests).
+     *
      * @param item  item to request beginRead for
      */
     void requestRead(ItemUaSdk &item);
@@ -120,24 +289,36 @@ public:
     /**
      * @brief Request a beginWrite service for an item
      *
+     * The outgoing data of the item is taken and pushed into the write request queue
+     * (or merged into a request for the same item that is still queued).
+     * It will be sent by the writer thread (batched with other requests).
+     *
      * @param item  item to request beginWrite for
      */
     void requestWrite(ItemUaSdk &item);
 
     /**
-     * @brief Initiate read of all nodes.
-     */
-    void readAllNodes();
-
-    /**
-     * @brief Create all subscriptions related to this session.
+     * @brief Initiate read of all nodes of a channel.
+     *
+     * Read requests for all items are pushed into the read request queue.
+     *
+     * @param channel  channel index
      */
-    void createAllSubscriptions();
+    void readAllNodes(const unsigned int channel);
 
     /**
-     * @brief Add all monitored items to subscriptions related to this session.
+     * @brief Create all subscriptions related to this session and add their monitored items.
+     *
+     * Subscriptions are set up in parallel (on a thread pool), each one adding
+     * its monitored items as soon as it has been created. Returns when all
+     * subscriptions are done.
+     *
+     * @param channel      channel index
+     * @param timings      timings of the running pipeline (gets the transfer counts)
+     * @param tryTransfer  try to transfer the subscriptions from the previous session first
      */
-    void addAllMonitoredItems();
+    void setupAllSubscriptions(const unsigned int channel, ConnectTimings &timings,
+                               const bool tryTransfer = false);
 
     /**
      * @brief Print configuration and status of all sessions on stdout.
@@ -174,6 +355,38 @@ public:
      */
     virtual void setOption(const std::string &name, const std::string &value) override;
 
+    /**
+     * @brief Get the max. number of nodes per service call for a server limit.
+     *
+     * Combines the server's operation limit with the batch-nodes option.
+     *
+     * @param serverLimit  operation limit of the server (0 = no limit)
+     *
+     * @return max. number of nodes per service call (0 = no limit)
+     */
+    OpcUa_UInt32 chunkSize(const OpcUa_UInt32 serverLimit) const;
+
+    /**
+     * @brief Run a bulk service in chunks, keeping up to chunk-window chunks in flight.
+     *
+     * The chunk function is called for consecutive ranges of the nodes,
+     * from the calling thread and (if the window is larger than 1) from
+     * threads of a pool that lives for the duration of the call.
+     * Chunk functions must only touch their own range of the nodes.
+     * Returns when all chunks are done.
+     *
+     * @param total  number of nodes
+     * @param chunk  max. nodes per chunk (0 = no limit)
+     * @param fn     chunk function, called with the index of the first node and the number of nodes
+     */
+    void forEachChunk(const size_t total, const size_t chunk,
+                      const std::function<void(size_t, OpcUa_UInt32)> &fn);
+
+    /**
+     * @brief Get the operation limits of the server (read after connecting).
+     */
+    const OperationLimits &getOperationLimits() const { return operationLimits; }
+
     unsigned int noOfSubscriptions() const { return static_cast<unsigned int>(subscriptions.size()); }
     unsigned int noOfItems() const { return static_cast<unsigned int>(items.size()); }
 
@@ -212,28 +425,136 @@ public:
     // Get a new (unique) transaction id
     OpcUa_UInt32 getTransactionId();
 
-    // UaSessionCallback interface
-    virtual void connectionStatusChanged(
-            OpcUa_UInt32 clientConnectionId,
-            UaClient::ServerStatus serverStatus) override;
+    // UaSessionCallback interface (forwarded by the channels)
+    void connectionStatusChanged(
+            ChannelUaSdk &channel,
+            UaClient::ServerStatus serverStatus);
 
-    virtual void readComplete(
+    void readComplete(
             OpcUa_UInt32 transactionId,
             const UaStatus &result,
             const UaDataValues &values,
-            const UaDiagnosticInfos &diagnosticInfos) override;
+            const UaDiagnosticInfos &diagnosticInfos);
 
-    virtual void writeComplete(
+    void writeComplete(
             OpcUa_UInt32 transactionId,
             const UaStatus &result,
             const UaStatusCodeArray &results,
-            const UaDiagnosticInfos &diagnosticInfos) override;
+            const UaDiagnosticInfos &diagnosticInfos);
+
+    // RequestConsumer<ReadRequest> interface
+    /**
+     * @brief Send a batch of read requests using a single beginRead service call (per channel).
+     *
+     * Called from the reader thread of the read request queue.
+     *
+     * @param batch  read requests to send
+     */
+    virtual void processRequests(std::vector<std::shared_ptr<ReadRequest>> &batch) override;
+
+    // RequestConsumer<WriteRequest> interface
+    /**
+     * @brief Send a batch of write requests using a single beginWrite service call (per channel).
+     *
+     * Called from the writer thread of the write request queue.
+     *
+     * @param batch  write requests to send
+     */
+    virtual void processRequests(std::vector<std::shared_ptr<WriteRequest>> &batch) override;
+
+    // RequestConsumer<ConnectRequest> interface
+    /**
+     * @brief Run the connect pipeline.
+     *
+     * Called from the connect thread, after the connection status changed.
+     * Reads the operation limits, registers nodes, queues reads for all
+     * nodes and sets up all subscriptions (as requested), timing each phase.
+     *
+     * @param batch  connect requests (merged into one pipeline run per channel)
+     */
+    virtual void processRequests(std::vector<std::shared_ptr<ConnectRequest>> &batch) override;
+
+    // TimerConsumer<OpDeadline> interface
+    /**
+     * @brief Fail all outstanding operations whose deadline has passed.
+     *
+     * Called from the housekeeping thread of the deadline timer wheel.
+     * Operations that have completed in the meantime are ignored.
+     *
+     * @param expired  deadlines that have passed
+     */
+    virtual void timersExpired(std::vector<OpDeadline> &expired) override;
+
+    // TimerConsumer<SampleDeadline> interface
+    /**
+     * @brief Deliver the sample blocks and windows whose time limit has passed.
+     *
+     * Called from the housekeeping thread of the sample timer wheel.
+     *
+     * @param expired  time limits that have passed
+     */
+    virtual void timersExpired(std::vector<SampleDeadline> &expired) override;
+
+    /**
+     * @brief Add the time limit for a sample block or window.
+     *
+     * The sample timer wheel is started on first use.
+     *
+     * @param delay     time limit [s]
+     * @param deadline  element and block/window
+     */
+    void addSampleDeadline(const double delay, const SampleDeadline &deadline);
 
 private:
     /**
-     * @brief Register all nodes that are configured to be registered.
+     * @brief Run the connect pipeline for one channel.
+     *
+     * Reads the operation limits, then (depending on the request) registers nodes,
+     * initiates reading all nodes and sets up the subscriptions of the channel.
+     *
+     * @param request  merged connect request for the channel
      */
-    void registerNodes();
+    void runConnectPipeline(const ConnectRequest &request);
+
+    /**
+     * @brief Send read requests (for items on one channel) using a beginRead service call.
+     *
+     * @param batch    read requests to send
+     * @param channel  channel to use
+     */
+    void sendReadRequests(std::vector<std::shared_ptr<ReadRequest>> &batch, ChannelUaSdk &channel);
+
+    /**
+     * @brief Send write requests (for items on one channel) using a beginWrite service call.
+     *
+     * @param batch    write requests to send
+     * @param channel  channel to use
+     */
+    void sendWriteRequests(std::vector<std::shared_ptr<WriteRequest>> &batch, ChannelUaSdk &channel);
+
+    /**
+     * @brief Register all nodes of a channel that are configured to be registered.
+     *
+     * @param channel  channel index
+     */
+    void registerNodes(const unsigned int channel);
+
+    /**
+     * @brief Fill the structure definition cache for all structured items of a channel.
+     *
+     * Reads the data types of the nodes and looks up their definitions
+     * in the session dictionary.
+     *
+     * @param channel  channel index
+     */
+    void prepareStructureDefinitions(const unsigned int channel);
+
+    /**
+     * @brief Read the server's operation limits and apply them to the request queues.
+     *
+     * @param channel  channel index
+     */
+    void readOperationLimits(const unsigned int channel);
 
     /**
      * @brief Rebuild nodeIds for all nodes that were registered.
@@ -241,9 +562,55 @@ private:
     void rebuildNodeIds();
 
     /**
-     * @brief Set all nodes of the session to INVALID.
+     * @brief Set all nodes of a channel to INVALID.
+     *
+     * @param channel  channel index
+     */
+    void invalidateAllNodes(const unsigned int channel);
+
+    /**
+     * @brief Activate a reserved operation and set its deadline.
+     *
+     * @param id       transaction id
+     * @param write    write (true) or read (false) operation
+     * @param channel  channel index the operation is sent on
+     */
+    void activateTransaction(const OpcUa_UInt32 id, const bool write, const unsigned int channel);
+
+    /**
+     * @brief Complete all outstanding operations of a channel with an error.
+     *
+     * Called when the channel is disconnected: responses of the lost session
+     * would never arrive (without ops-timeout), leaving records active and
+     * shared items with a pending read.
+     *
+     * @param channel  channel index
+     * @param status   status to complete the operations with
+     */
+    void failOutstandingOps(const unsigned int channel, const OpcUa_StatusCode status);
+
+    /**
+     * @brief Release a finished operation, freeing its slot in the table.
+     *
+     * @param id  transaction id
+     */
+    void releaseTransaction(const OpcUa_UInt32 id);
+
+    /**
+     * @brief Reserve a slot in the table of outstanding operations.
+     *
+     * Waits while the max. number of operations is in flight (ops-window).
+     * Tries successive transaction ids until a free slot is found.
+     * If the table is full, applies the overflow policy: either fail
+     * (reject) or wait for a slot to become free (while connected).
+     * Waiting ends when the channel that will carry the operation disconnects.
+     *
+     * @param[out] id  transaction id of the reserved slot
+     * @param channel  channel that will carry the operation
+     *
+     * @return pointer to the slot's (empty) item list, nullptr if no slot could be reserved
      */
-    void invalidateAllNodes();
+    std::vector<ItemUaSdk *> *reserveTransaction(OpcUa_UInt32 &id, const ChannelUaSdk &channel);
 
     static std::map<std::string, SessionUaSdk *> sessions;    /**< session management */
 
@@ -253,14 +620,47 @@ private:
     std::map<std::string, SubscriptionUaSdk*> subscriptions;  /**< subscriptions on this session */
     std::vector<ItemUaSdk *> items;                           /**< items on this session */
     OpcUa_UInt32 registeredItemsNo;                           /**< number of registered items */
-    UaSession* puasession;                                    /**< pointer to low level session */
+    std::vector<std::unique_ptr<ChannelUaSdk>> channels;      /**< channels (low level sessions) */
     SessionConnectInfo connectInfo;                           /**< connection metadata */
     SessionSecurityInfo securityInfo;                         /**< security metadata */
-    UaClient::ServerStatus serverConnectionStatus;            /**< connection status for this session */
     int transactionId;                                        /**< next transaction id */
     /** itemUaSdk vectors of outstanding read or write operations, indexed by transaction id */
-    std::map<OpcUa_UInt32, std::unique_ptr<std::vector<ItemUaSdk *>>> outstandingOps;
-    epicsMutex opslock;                                      /**< lock for outstandingOps map */
+    TransactionTable<ItemUaSdk> outstandingOps;
+    bool opsOverflowWait;                                    /**< overflow policy: wait (true) or reject */
+    int opsOverflows;                                        /**< number of times the table was full */
+    unsigned int opsWindow;                                  /**< max. operations in flight (0 = no limit) */
+    unsigned int chunkWindow;                                /**< max. chunks of a bulk service in flight */
+    epicsEvent opsDone;                                      /**< signalled when an operation is released */
+    OperationLimits operationLimits;                         /**< operation limits of the server */
+    double opsTimeout;                                       /**< timeout for outstanding operations [s] */
+    int opsExpired;                                          /**< number of timed out operations */
+    TimerWheel<OpDeadline> deadlines;                        /**< deadlines of outstanding operations */
+    TimerWheel<SampleDeadline> sampleDeadlines;              /**< time limits of sample blocks and windows */
+    RequestQueueBatcher<ConnectRequest> connectQueue;        /**< connect request queue and connect thread */
+    epicsThreadPool *setupPool;                              /**< thread pool for subscription setup */
+    std::vector<ConnectTimings> connectTimings;              /**< timing of the last connect pipeline run, by channel */
+    mutable epicsMutex timingslock;                          /**< lock for connectTimings */
+    /** structure definitions, by encoding type id */
+    std::map<UaNodeId, UaStructureDefinition> structureDefinitions;
+    mutable epicsMutex structurelock;                        /**< lock for structureDefinitions */
+    int structureLookups;                                    /**< number of dictionary lookups (cache misses) */
+    int definitionsGeneration;                               /**< incremented when structureDefinitions is cleared */
+    bool plannedDecoder;                                     /**< decode structures using decoding plans */
+    bool batchScan;                                          /**< batch I/O Intr processing per notification */
+    unsigned int executorThreads;                            /**< executor worker threads (0 = no executor) */
+    unsigned int executorPriority;                           /**< executor worker thread priority */
+    std::unique_ptr<ProcessingExecutor> executor;            /**< record processing executor */
+    unsigned int decoderThreads;                             /**< decoder pool threads (0 = no pool) */
+    unsigned int decoderPriority;                            /**< decoder pool thread priority */
+    epicsThreadPool *decoderPool;                            /**< thread pool for data change processing */
+    RequestQueueBatcher<ReadRequest> readQueue;              /**< read request queue and reader thread */
+    RequestQueueBatcher<WriteRequest> writeQueue;            /**< write request queue and writer thread */
+    /** queued write requests, indexed by item */
+    std::unordered_map<ItemUaSdk *, std::shared_ptr<WriteRequest>> pendingWrites;
+    epicsMutex writelock;                                    /**< lock for pendingWrites map */
+    unsigned long writesCoalesced;                           /**< number of writes merged into queued requests */
+    int readsCached;                                         /**< number of reads served from cached values */
+    int readsSaved;                                          /**< number of reads attached to a pending read */
 };
 
 } // namespace DevOpcua
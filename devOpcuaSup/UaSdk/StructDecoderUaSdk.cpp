@@ -0,0 +1,280 @@
+/*************************************************************************\
+* Copyright (c) 2026 ITER Organization.
+* This module is distributed subject to a Software License Agreement found
+* in file LICENSE that is included with this distribution.
+\*************************************************************************/
+
+/*
+ *  Author: agent <agent@local>
+ */
+
+#include <string>
+#include <cstring>
+#include <algorithm>
+
+#include <uadatetime.h>
+#include <opcua_builtintypes.h>
+
+#include <epicsTypes.h>
+
+#define epicsExportSharedSymbols
+#include "StructDecoderUaSdk.h"
+
+namespace DevOpcua {
+
+// Encoded size of fixed size built-in types (0 = variable size or not supported)
+static size_t
+encodedSize (const OpcUa_BuiltInType type)
+{
+    switch (type) {
+    case OpcUaType_Boolean:
+    case OpcUaType_SByte:
+    case OpcUaType_Byte:
+        return 1;
+    case OpcUaType_Int16:
+    case OpcUaType_UInt16:
+        return 2;
+    case OpcUaType_Int32:
+    case OpcUaType_UInt32:
+    case OpcUaType_Float:
+    case OpcUaType_StatusCode:
+        return 4;
+    case OpcUaType_Int64:
+    case OpcUaType_UInt64:
+    case OpcUaType_Double:
+    case OpcUaType_DateTime:
+        return 8;
+    case OpcUaType_Guid:
+        return 16;
+    default:
+        return 0;
+    }
+}
+
+// Types that are encoded as Int32 length + bytes
+static bool
+isByteSequence (const OpcUa_BuiltInType type)
+{
+    return (type == OpcUaType_String
+            || type == OpcUaType_ByteString
+            || type == OpcUaType_XmlElement);
+}
+
+// Types that the plan can extract (all others can only be skipped)
+static bool
+isExtractable (const OpcUa_BuiltInType type)
+{
+    return (type != OpcUaType_Guid && type != OpcUaType_XmlElement
+            && (encodedSize(type) || isByteSequence(type)));
+}
+
+namespace {
+// Little endian reader on a binary body
+class BinaryReader
+{
+public:
+    BinaryReader(const OpcUa_ByteString &body)
+        : pos(body.Data)
+        , end(body.Data + (body.Length > 0 ? body.Length : 0))
+    {}
+
+    bool skip(const size_t n)
+    {
+        if (static_cast<size_t>(end - pos) < n)
+            return false;
+        pos += n;
+        return true;
+    }
+
+    bool get(epicsUInt64 &value, const size_t n)
+    {
+        if (static_cast<size_t>(end - pos) < n)
+            return false;
+        value = 0;
+        for (size_t i = 0; i < n; i++)
+            value |= static_cast<epicsUInt64>(pos[i]) << (8 * i);
+        pos += n;
+        return true;
+    }
+
+    bool getLength(OpcUa_Int32 &length)
+    {
+        epicsUInt64 v;
+        if (!get(v, 4))
+            return false;
+        length = static_cast<OpcUa_Int32>(static_cast<epicsUInt32>(v));
+        return true;
+    }
+
+    const OpcUa_Byte *current() const { return pos; }
+
+private:
+    const OpcUa_Byte *pos;
+    const OpcUa_Byte *end;
+};
+}
+
+std::unique_ptr<StructDecoderUaSdk>
+StructDecoderUaSdk::compile (const UaStructureDefinition &definition,
+                             const std::vector<int> &wanted)
+{
+    if (definition.isNull() || definition.isUnion() || definition.hasOptionalFields() || wanted.empty())
+        return nullptr;
+
+    int last = *std::max_element(wanted.begin(), wanted.end());
+    if (last >= definition.childrenCount())
+        return nullptr;
+
+    std::unique_ptr<StructDecoderUaSdk> plan(new StructDecoderUaSdk);
+    for (int i = 0; i <= last; i++) {
+        UaStructureField field = definition.child(i);
+        Step step;
+        step.type = field.valueType();
+        step.output = -1;
+        for (size_t k = 0; k < wanted.size(); k++) {
+            if (wanted[k] == i)
+                step.output = static_cast<int>(k);
+        }
+        switch (field.arrayType()) {
+        case UaStructureField::ArrayType_Scalar:
+            step.isArray = false;
+            break;
+        case UaStructureField::ArrayType_Array:
+            step.isArray = true;
+            break;
+        default:
+            return nullptr;
+        }
+        // Nested structures, variants, node ids etc. need the generic decoder
+        if (!encodedSize(step.type) && !isByteSequence(step.type))
+            return nullptr;
+        if (step.output >= 0 && (step.isArray || !isExtractable(step.type)))
+            return nullptr;
+        plan->steps.push_back(step);
+    }
+    plan->noOfOutputs = wanted.size();
+    return plan;
+}
+
+bool
+StructDecoderUaSdk::decode (const OpcUa_ByteString &body, std::vector<UaVariant> &values) const
+{
+    BinaryReader reader(body);
+    OpcUa_Int32 length;
+    epicsUInt64 raw;
+
+    values.resize(noOfOutputs);
+    for (auto &step : steps) {
+        const size_t size = encodedSize(step.type);
+
+        if (step.output < 0) {
+            if (step.isArray) {
+                if (!reader.getLength(length))
+                    return false;
+                if (length <= 0)
+                    continue;
+                if (size) {
+                    if (!reader.skip(size * static_cast<size_t>(length)))
+                        return false;
+                } else {
+                    for (OpcUa_Int32 n = 0; n < length; n++) {
+                        OpcUa_Int32 l;
+                        if (!reader.getLength(l) || (l > 0 && !reader.skip(static_cast<size_t>(l))))
+                            return false;
+                    }
+                }
+            } else if (size) {
+                if (!reader.skip(size))
+                    return false;
+            } else {
+                if (!reader.getLength(length) || (length > 0 && !reader.skip(static_cast<size_t>(length))))
+                    return false;
+            }
+            continue;
+        }
+
+        UaVariant &value = values[static_cast<size_t>(step.output)];
+        if (isByteSequence(step.type)) {
+            if (!reader.getLength(length))
+                return false;
+            const OpcUa_Byte *data = reader.current();
+            if (length > 0 && !reader.skip(static_cast<size_t>(length)))
+                return false;
+            if (step.type == OpcUaType_String) {
+                if (length < 0) {
+                    value.setString(UaString());
+                } else {
+                    std::string s(reinterpret_cast<const char *>(data), static_cast<size_t>(length));
+                    value.setString(UaString(s.c_str()));
+                }
+            } else {
+                UaByteString bs(length > 0 ? length : 0, const_cast<OpcUa_Byte *>(data));
+                value.setByteString(bs, OpcUa_True);
+            }
+            continue;
+        }
+
+        if (!reader.get(raw, size))
+            return false;
+        switch (step.type) {
+        case OpcUaType_Boolean:
+            value.setBoolean(raw ? OpcUa_True : OpcUa_False);
+            break;
+        case OpcUaType_SByte:
+            value.setSByte(static_cast<OpcUa_SByte>(raw));
+            break;
+        case OpcUaType_Byte:
+            value.setByte(static_cast<OpcUa_Byte>(raw));
+            break;
+        case OpcUaType_Int16:
+            value.setInt16(static_cast<OpcUa_Int16>(raw));
+            break;
+        case OpcUaType_UInt16:
+            value.setUInt16(static_cast<OpcUa_UInt16>(raw));
+            break;
+        case OpcUaType_Int32:
+            value.setInt32(static_cast<OpcUa_Int32>(raw));
+            break;
+        case OpcUaType_UInt32:
+            value.setUInt32(static_cast<OpcUa_UInt32>(raw));
+            break;
+        case OpcUaType_StatusCode:
+            value.setStatusCode(static_cast<OpcUa_StatusCode>(raw));
+            break;
+        case OpcUaType_Int64:
+            value.setInt64(static_cast<OpcUa_Int64>(raw));
+            break;
+        case OpcUaType_UInt64:
+            value.setUInt64(static_cast<OpcUa_UInt64>(raw));
+            break;
+        case OpcUaType_Float:
+        {
+            epicsUInt32 bits = static_cast<epicsUInt32>(raw);
+            OpcUa_Float f;
+            std::memcpy(&f, &bits, sizeof(f));
+            value.setFloat(f);
+            break;
+        }
+        case OpcUaType_Double:
+        {
+            OpcUa_Double d;
+            std::memcpy(&d, &raw, sizeof(d));
+            value.setDouble(d);
+            break;
+        }
+        case OpcUaType_DateTime:
+        {
+            OpcUa_DateTime dt;
+            dt.dwLowDateTime = static_cast<OpcUa_UInt32>(raw);
+            dt.dwHighDateTime = static_cast<OpcUa_UInt32>(raw >> 32);
+            value.setDateTime(UaDateTime(dt));
+            break;
+        }
+        default:
+            return false;
+        }
+    }
+    return true;
+}
+
+} // namespace DevOpcua
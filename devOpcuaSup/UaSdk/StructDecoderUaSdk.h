@@ -0,0 +1,79 @@
+/*************************************************************************\
+* Copyright (c) 2026 ITER Organization.
+* This module is distributed subject to a Software License Agreement found
+* in file LICENSE that is included with this distribution.
+\*************************************************************************/
+
+/*
+ *  Author: agent <agent@local>
+ */
+
+#ifndef DEVOPCUA_STRUCTDECODERUASDK_H
+#define DEVOPCUA_STRUCTDECODERUASDK_H
+
+#include <vector>
+#include <memory>
+
+#include <uabase.h>
+#include <uavariant.h>
+#include <uastructuredefinition.h>
+
+namespace DevOpcua {
+
+/**
+ * @brief A decoding plan for the binary body of a structured ExtensionObject.
+ *
+ * The plan is compiled once per structure definition and set of wanted
+ * (mapped) fields. Decoding walks the binary body once, extracting only the
+ * wanted fields and skipping the others by their encoded size. Decoding stops
+ * after the last wanted field.
+ *
+ * Only structures consisting of built-in scalar types, strings and
+ * (skipped) one-dimensional arrays of those are supported. Compiling a plan
+ * for any other structure fails, and the caller uses the generic decoder.
+ */
+class StructDecoderUaSdk
+{
+public:
+    /**
+     * @brief Compile a decoding plan.
+     *
+     * @param definition  structure definition
+     * @param wanted      indices of the wanted fields in the structure
+     *
+     * @return decoding plan, nullptr if the structure is not supported
+     */
+    static std::unique_ptr<StructDecoderUaSdk> compile(const UaStructureDefinition &definition,
+                                                       const std::vector<int> &wanted);
+
+    /**
+     * @brief Decode the wanted fields from a binary body.
+     *
+     * @param body    binary encoded body of the ExtensionObject
+     * @param values  [out] values of the wanted fields (in the order of compile's wanted)
+     *
+     * @return true if successful, false if the body is too short or malformed
+     */
+    bool decode(const OpcUa_ByteString &body, std::vector<UaVariant> &values) const;
+
+    /**
+     * @brief Get the number of fields the plan walks through.
+     */
+    size_t noOfSteps() const { return steps.size(); }
+
+private:
+    struct Step {
+        OpcUa_BuiltInType type;  /**< built-in type of the field */
+        bool isArray;            /**< field is a one-dimensional array */
+        int output;              /**< index in the output values (-1 = skip) */
+    };
+
+    StructDecoderUaSdk() : noOfOutputs(0) {}
+
+    std::vector<Step> steps;     /**< fields (in encoding order, up to the last wanted field) */
+    size_t noOfOutputs;          /**< number of wanted fields */
+};
+
+} // namespace DevOpcua
+
+#endif // DEVOPCUA_STRUCTDECODERUASDK_H
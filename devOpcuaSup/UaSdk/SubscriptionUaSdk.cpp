@@ -19,6 +19,8 @@
 #include <uasession.h>
 
 #include <errlog.h>
+#include <epicsTime.h>
+#include <epicsAtomic.h>
 
 #define epicsExportSharedSymbols
 #include "SubscriptionUaSdk.h"
@@ -38,8 +40,20 @@ SubscriptionUaSdk::SubscriptionUaSdk (const std::string &name, SessionUaSdk *ses
     : Subscription(name, debug)
     , puasubscription(nullptr)
     , psessionuasdk(session)
+    , channel(session->channelForSubscription(name))
     //TODO: add runtime support for subscription enable/disable
     , enable(true)
+    , subscriptionId(0)
+    , transferred(false)
+    , transferTime(0.0)
+    , createTime(0.0)
+    , addItemsTime(0.0)
+    , republished(0)
+    , recreatedItems(0)
+    , decoder(nullptr)
+    , decoderScheduled(0)
+    , deferred(0)
+    , jobQueueFailures(0)
 {
     // keep the default timeout
     double deftimeout = subscriptionSettings.publishingInterval * subscriptionSettings.lifetimeCount;
@@ -72,7 +86,18 @@ SubscriptionUaSdk::show (int level) const
               << "(" << (enable ? "Y" : "N") << ")"
               << " debug=" << debug
               << " items=" << items.size()
-              << std::endl;
+              << " setup(transfer/create/add)=" << transferTime
+              << "/" << createTime << "/" << addItemsTime << "ms"
+              << (transferred ? " transferred" : "");
+    if (transferred)
+        std::cout << "(" << republished << " republished, "
+                  << recreatedItems << " items recreated)";
+    if (psessionuasdk->useBatchScan())
+        batch.show();
+    if (decoder)
+        std::cout << " deferred=" << epics::atomic::get(deferred)
+                  << "(" << epics::atomic::get(jobQueueFailures) << " queue failures)";
+    std::cout << std::endl;
 
     if (level >= 1) {
         for (auto &it : items) {
@@ -130,7 +155,7 @@ SubscriptionUaSdk::create ()
     UaStatus status;
     ServiceSettings serviceSettings;
 
-    status = psessionuasdk->puasession->createSubscription(
+    status = psessionuasdk->channels[channel]->getUaSession()->createSubscription(
                 serviceSettings,
                 this,
                 0,
@@ -142,63 +167,226 @@ SubscriptionUaSdk::create ()
         errlogPrintf("OPC UA subscription %s: createSubscription on session %s failed (%s)\n",
                      name.c_str(), psessionuasdk->getName().c_str(), status.toString().toUtf8());
     } else {
+        subscriptionId = puasubscription->subscriptionId();
         if (debug)
             errlogPrintf("OPC UA subscription %s on session %s created (%s)\n",
                          name.c_str(), psessionuasdk->getName().c_str(), status.toString().toUtf8());
     }
 }
 
-void
-SubscriptionUaSdk::addMonitoredItems ()
+bool
+SubscriptionUaSdk::transfer ()
 {
     UaStatus status;
     ServiceSettings serviceSettings;
-    OpcUa_UInt32 i;
-    UaMonitoredItemCreateRequests monitoredItemCreateRequests;
-    UaMonitoredItemCreateResults monitoredItemCreateResults;
-
-    monitoredItemCreateRequests.create(static_cast<OpcUa_UInt32>(items.size()));
-    i = 0;
-    for (auto &it : items) {
-        it->getNodeId().copyTo(&monitoredItemCreateRequests[i].ItemToMonitor.NodeId);
-        monitoredItemCreateRequests[i].ItemToMonitor.AttributeId = OpcUa_Attributes_Value;
-        monitoredItemCreateRequests[i].MonitoringMode = OpcUa_MonitoringMode_Reporting;
-        monitoredItemCreateRequests[i].RequestedParameters.ClientHandle = i;
-        monitoredItemCreateRequests[i].RequestedParameters.SamplingInterval = it->linkinfo.samplingInterval;
-        monitoredItemCreateRequests[i].RequestedParameters.QueueSize = it->linkinfo.queueSize;
-        monitoredItemCreateRequests[i].RequestedParameters.DiscardOldest = it->linkinfo.discardOldest;
-        i++;
-    }
+    UaUInt32Array availableSequenceNumbers;
 
-    status = puasubscription->createMonitoredItems(
-                serviceSettings,               // Use default settings
-                OpcUa_TimestampsToReturn_Both, // Select timestamps to return
-                monitoredItemCreateRequests,   // monitored items to create
-                monitoredItemCreateResults);   // Returned monitored items create result
+    if (!subscriptionId)
+        return false;
+
+    // Publishing stays disabled until the missed notifications have been republished,
+    // so that the initial values (current values) arrive after them
+    status = psessionuasdk->channels[channel]->getUaSession()->transferSubscription(
+                serviceSettings,
+                this,
+                0,
+                subscriptionId,
+                subscriptionSettings,
+                OpcUa_False,            // publishing enabled
+                OpcUa_True,             // send initial values
+                &puasubscription,
+                availableSequenceNumbers);
 
     if (status.isBad()) {
-        errlogPrintf("OPC UA subscription %s@%s: createMonitoredItems failed with status %s\n",
-                     name.c_str(), psessionuasdk->getName().c_str(), status.toString().toUtf8());
+        errlogPrintf("OPC UA subscription %s: transferSubscription (id %u) to session %s failed (%s)"
+                     " - creating it\n",
+                     name.c_str(), subscriptionId, psessionuasdk->getName().c_str(),
+                     status.toString().toUtf8());
+        return false;
     } else {
         if (debug)
-            std::cout << "Subscription " << name << "@" << psessionuasdk->getName()
-                      << ": created " << items.size() << " monitored items ("
-                      << status.toString().toUtf8() << ")" << std::endl;
-        if (debug >= 5) {
-            for (i = 0; i < items.size(); i++) {
-                UaNodeId node(monitoredItemCreateRequests[i].ItemToMonitor.NodeId);
+            errlogPrintf("OPC UA subscription %s (id %u) transferred to session %s (%s)\n",
+                         name.c_str(), subscriptionId, psessionuasdk->getName().c_str(),
+                         status.toString().toUtf8());
+        republish(availableSequenceNumbers);
+        recreateRegisteredItems();
+        if (enable) {
+            status = puasubscription->setPublishingMode(serviceSettings, OpcUa_True);
+            if (status.isBad())
+                errlogPrintf("OPC UA subscription %s@%s: setPublishingMode failed with status %s\n",
+                             name.c_str(), psessionuasdk->getName().c_str(), status.toString().toUtf8());
+        }
+        return true;
+    }
+}
+
+void
+SubscriptionUaSdk::republish (const UaUInt32Array &sequenceNumbers)
+{
+    ServiceSettings serviceSettings;
+
+    // Notifications that the previous session did not acknowledge (may include
+    // some that were received, but whose acknowledgement was lost)
+    republished = 0;
+    for (OpcUa_UInt32 i = 0; i < sequenceNumbers.length(); i++) {
+        UaDataNotifications dataNotifications;
+        UaDiagnosticInfos diagnosticInfos;
+        UaEventFieldLists eventFieldList;
+        UaStatus statusChange;
+        UaStatus status = puasubscription->republish(serviceSettings, sequenceNumbers[i],
+                                                     dataNotifications, diagnosticInfos,
+                                                     eventFieldList, statusChange);
+        if (status.isBad()) {
+            // The server may have discarded the message in the meantime
+            if (debug)
+                errlogPrintf("OPC UA subscription %s@%s: republish (sequence number %u) failed with status %s\n",
+                             name.c_str(), psessionuasdk->getName().c_str(), sequenceNumbers[i],
+                             status.toString().toUtf8());
+            continue;
+        }
+        republished++;
+        if (dataNotifications.length())
+            dataChange(0, dataNotifications, diagnosticInfos);
+    }
+}
+
+void
+SubscriptionUaSdk::recreateRegisteredItems ()
+{
+    ServiceSettings serviceSettings;
+    UaUInt32Array monitoredItemIds;
+    UaStatusCodeArray results;
+    std::vector<OpcUa_UInt32> handles;
+
+    // Registered node ids are only valid within a session: the transferred monitored
+    // items of registered nodes are replaced by ones using the ids of the new session
+    recreatedItems = 0;
+    for (OpcUa_UInt32 i = 0; i < items.size(); i++)
+        if (items[i]->linkinfo.registerNode && items[i]->getMonitoredItemId())
+            handles.push_back(i);
+    if (handles.empty())
+        return;
+
+    monitoredItemIds.create(static_cast<OpcUa_UInt32>(handles.size()));
+    for (OpcUa_UInt32 i = 0; i < handles.size(); i++) {
+        monitoredItemIds[i] = items[handles[i]]->getMonitoredItemId();
+        items[handles[i]]->setMonitoredItemId(0);
+    }
+    UaStatus status = puasubscription->deleteMonitoredItems(serviceSettings, monitoredItemIds, results);
+    if (status.isBad())
+        errlogPrintf("OPC UA subscription %s@%s: deleteMonitoredItems failed with status %s\n",
+                     name.c_str(), psessionuasdk->getName().c_str(), status.toString().toUtf8());
+
+    addMonitoredItems(handles);
+    for (auto handle : handles)
+        if (items[handle]->getMonitoredItemId())
+            recreatedItems++;
+}
+
+void
+SubscriptionUaSdk::addMonitoredItems ()
+{
+    std::vector<OpcUa_UInt32> handles(items.size());
+    for (OpcUa_UInt32 i = 0; i < handles.size(); i++)
+        handles[i] = i;
+    addMonitoredItems(handles);
+}
+
+void
+SubscriptionUaSdk::addMonitoredItems (const std::vector<OpcUa_UInt32> &handles)
+{
+    // Split into chunks that comply with the server's operation limits
+    psessionuasdk->forEachChunk(handles.size(),
+                                psessionuasdk->chunkSize(psessionuasdk->getOperationLimits().maxMonitoredItemsPerCall),
+                                [&](size_t first, OpcUa_UInt32 n) {
+        UaStatus status;
+        ServiceSettings serviceSettings;
+        OpcUa_UInt32 i;
+        UaMonitoredItemCreateRequests monitoredItemCreateRequests;
+        UaMonitoredItemCreateResults monitoredItemCreateResults;
+
+        monitoredItemCreateRequests.create(n);
+        for (i = 0; i < n; i++) {
+            ItemUaSdk *it = items[handles[first + i]];
+            it->setMonitoredItemId(0);
+            it->getNodeId().copyTo(&monitoredItemCreateRequests[i].ItemToMonitor.NodeId);
+            monitoredItemCreateRequests[i].ItemToMonitor.AttributeId = OpcUa_Attributes_Value;
+            monitoredItemCreateRequests[i].MonitoringMode = OpcUa_MonitoringMode_Reporting;
+            // client handle is the index into the items vector
+            monitoredItemCreateRequests[i].RequestedParameters.ClientHandle = handles[first + i];
+            monitoredItemCreateRequests[i].RequestedParameters.SamplingInterval = it->linkinfo.samplingInterval;
+            monitoredItemCreateRequests[i].RequestedParameters.QueueSize = it->linkinfo.queueSize;
+            monitoredItemCreateRequests[i].RequestedParameters.DiscardOldest = it->linkinfo.discardOldest;
+            // Data change filter (only if it differs from the server default)
+            if (it->linkinfo.deadbandType || it->linkinfo.dataChangeTrigger != OpcUa_DataChangeTrigger_StatusValue) {
+                OpcUa_DataChangeFilter *filter = nullptr;
+                if (OpcUa_IsGood(OpcUa_EncodeableObject_CreateExtension(
+                                     &OpcUa_DataChangeFilter_EncodeableType,
+                                     &monitoredItemCreateRequests[i].RequestedParameters.Filter,
+                                     reinterpret_cast<OpcUa_Void **>(&filter))) && filter) {
+                    filter->Trigger = static_cast<OpcUa_DataChangeTrigger>(it->linkinfo.dataChangeTrigger);
+                    filter->DeadbandType = it->linkinfo.deadbandType;
+                    filter->DeadbandValue = it->linkinfo.deadbandValue;
+                }
+            }
+        }
+
+        status = puasubscription->createMonitoredItems(
+                    serviceSettings,               // Use default settings
+                    OpcUa_TimestampsToReturn_Both, // Select timestamps to return
+                    monitoredItemCreateRequests,   // monitored items to create
+                    monitoredItemCreateResults);   // Returned monitored items create result
+
+        if (status.isBad()) {
+            errlogPrintf("OPC UA subscription %s@%s: createMonitoredItems failed with status %s\n",
+                         name.c_str(), psessionuasdk->getName().c_str(), status.toString().toUtf8());
+        } else {
+            if (debug)
+                std::cout << "Subscription " << name << "@" << psessionuasdk->getName()
+                          << ": created " << n << " monitored items ("
+                          << status.toString().toUtf8() << ")" << std::endl;
+            for (i = 0; i < n && i < monitoredItemCreateResults.length(); i++)
                 if (OpcUa_IsGood(monitoredItemCreateResults[i].StatusCode))
-                    std::cout << "** Monitored item " << node.toXmlString().toUtf8()
-                              << " succeeded with id " << monitoredItemCreateResults[i].MonitoredItemId
-                              << std::endl;
-                else
-                    std::cout << "** Monitored item " << node.toXmlString().toUtf8()
-                              << " failed with error "
-                              << UaStatus(monitoredItemCreateResults[i].StatusCode).toString().toUtf8()
-                              << std::endl;
+                    items[handles[first + i]]->setMonitoredItemId(monitoredItemCreateResults[i].MonitoredItemId);
+            if (debug >= 5) {
+                for (i = 0; i < n && i < monitoredItemCreateResults.length(); i++) {
+                    UaNodeId node(monitoredItemCreateRequests[i].ItemToMonitor.NodeId);
+                    if (OpcUa_IsGood(monitoredItemCreateResults[i].StatusCode))
+                        std::cout << "** Monitored item " << node.toXmlString().toUtf8()
+                                  << " succeeded with id " << monitoredItemCreateResults[i].MonitoredItemId
+                                  << std::endl;
+                    else
+                        std::cout << "** Monitored item " << node.toXmlString().toUtf8()
+                                  << " failed with error "
+                                  << UaStatus(monitoredItemCreateResults[i].StatusCode).toString().toUtf8()
+                                  << std::endl;
+                }
             }
         }
+    });
+}
+
+void
+SubscriptionUaSdk::setup (const bool tryTransfer)
+{
+    epicsTime start = epicsTime::getCurrent();
+    transferred = false;
+    if (tryTransfer) {
+        transferred = transfer();
+        epicsTime done = epicsTime::getCurrent();
+        transferTime = (done - start) * 1e3;
+        if (transferred) {
+            createTime = addItemsTime = 0.0;
+            return;
+        }
+        start = done;
     }
+    create();
+    epicsTime created = epicsTime::getCurrent();
+    createTime = (created - start) * 1e3;
+    if (puasubscription)
+        addMonitoredItems();
+    addItemsTime = (epicsTime::getCurrent() - created) * 1e3;
 }
 
 void
@@ -234,14 +422,54 @@ SubscriptionUaSdk::dataChange (OpcUa_UInt32 clientSubscriptionHandle,
                                const UaDataNotifications& dataNotifications,
                                const UaDiagnosticInfos&   diagnosticInfos)
 {
-    OpcUa_UInt32 i;
-
     if (debug)
         std::cout << "Subscription " << name.c_str()
                   << "@" << psessionuasdk->getName()
                   << ": (dataChange) getting data for "
                   << dataNotifications.length() << " items" << std::endl;
 
+    if (decoder) {
+        // The notifications belong to the SDK: queue a (deep) copy for the decoder
+        std::unique_ptr<UaDataNotifications> notifications(new UaDataNotifications(dataNotifications));
+        incoming.push(std::move(notifications));
+        epics::atomic::increment(deferred);
+        scheduleDecoder();
+        return;
+    }
+    processDataChange(dataNotifications);
+}
+
+void
+SubscriptionUaSdk::scheduleDecoder ()
+{
+    if (epics::atomic::compareAndSwap(decoderScheduled, 0, 1) != 0)
+        return;
+    if (epicsJobQueue(decoder)) {
+        // Pool not accepting jobs: drain the queue in this thread (keeps the order)
+        epics::atomic::increment(jobQueueFailures);
+        if (debug)
+            errlogPrintf("OPC UA subscription %s@%s: cannot queue decoder job - decoding in caller\n",
+                         name.c_str(), psessionuasdk->getName().c_str());
+        decodeQueued();
+    }
+}
+
+bool
+SubscriptionUaSdk::queueConnectionLoss ()
+{
+    if (!decoder)
+        return false;
+    incoming.push(std::unique_ptr<UaDataNotifications>());
+    scheduleDecoder();
+    return true;
+}
+
+void
+SubscriptionUaSdk::processDataChange (const UaDataNotifications &dataNotifications)
+{
+    OpcUa_UInt32 i;
+
+    ProcessingBatch::Collector collector(psessionuasdk->useBatchScan() ? &batch : nullptr);
     for (i = 0; i < dataNotifications.length(); i++) {
         ItemUaSdk *item = items[dataNotifications[i].ClientHandle];
         if (debug >= 5) {
@@ -253,11 +481,56 @@ SubscriptionUaSdk::dataChange (OpcUa_UInt32 clientSubscriptionHandle,
                 std::cout << "/" << item->linkinfo.identifierString;
             std::cout << ")" << std::endl;
         }
-        item->setIncomingData(dataNotifications[i].Value);
+        item->setIncomingData(dataNotifications[i].Value, ProcessReason::incomingData);
         item->requestRecordProcessing(ProcessReason::incomingData);
     }
 }
 
+void
+SubscriptionUaSdk::useDecoderPool (epicsThreadPool *pool)
+{
+    if (!decoder)
+        decoder = epicsJobCreate(pool, SubscriptionUaSdk::decodeJob, this);
+    if (!decoder)
+        errlogPrintf("OPC UA subscription %s@%s: cannot create decoder job - decoding in dataChange\n",
+                     name.c_str(), psessionuasdk->getName().c_str());
+}
+
+void
+SubscriptionUaSdk::decodeJob (void *arg, epicsJobMode mode)
+{
+    SubscriptionUaSdk *subscription = static_cast<SubscriptionUaSdk *>(arg);
+
+    if (mode == epicsJobModeCleanup) {
+        epicsJobDestroy(subscription->decoder);
+        subscription->decoder = nullptr;
+        return;
+    }
+    subscription->decodeQueued();
+}
+
+void
+SubscriptionUaSdk::decodeQueued ()
+{
+    // Only one thread per subscription runs this at a time (keeps the order of notifications)
+    std::unique_ptr<UaDataNotifications> notifications;
+    while (true) {
+        while (incoming.pop(notifications)) {
+            if (notifications) {
+                processDataChange(*notifications);
+            } else {
+                for (auto item : items)
+                    item->requestRecordProcessing(ProcessReason::connectionLoss);
+            }
+        }
+        epics::atomic::set(decoderScheduled, 0);
+        // A notification pushed after the last pop would have found the flag set
+        if (incoming.isEmpty()
+                || epics::atomic::compareAndSwap(decoderScheduled, 0, 1) != 0)
+            break;
+    }
+}
+
 void
 SubscriptionUaSdk::newEvents (OpcUa_UInt32 clientSubscriptionHandle,
                               UaEventFieldLists& eventFieldList)
@@ -19,9 +19,12 @@
 #include <uasubscription.h>
 
 #include <epicsTypes.h>
+#include <epicsThreadPool.h>
 
 #include "SessionUaSdk.h"
 #include "Subscription.h"
+#include "RecordConnector.h"
+#include "MpscQueue.h"
 
 namespace DevOpcua {
 
@@ -102,6 +105,12 @@ public:
      */
     SessionUaSdk &getSessionUaSdk() const;
 
+    /**
+     * @brief Get the index of the session channel that this subscription
+     * is running on.
+     */
+    unsigned int getChannel() const { return channel; }
+
     /**
      * @brief Add an item (implementation) to the subscription.
      *
@@ -140,6 +149,40 @@ public:
      */
     void addMonitoredItems();
 
+    /**
+     * @brief Transfer the subscription from a previous session to the current session.
+     *
+     * Uses the TransferSubscriptions service with the subscription id of
+     * the previous session. The server keeps the monitored items.
+     * Before publishing is enabled again, the notifications that the
+     * server still holds (not acknowledged by the previous session) are
+     * republished, then the server sends the current values of all items.
+     * Notifications that the server has already discarded are lost;
+     * the current values bring the records up to date.
+     * Monitored items of registered nodes are recreated with the node ids
+     * registered on the new session.
+     *
+     * @return true if the subscription was transferred
+     */
+    bool transfer();
+
+    /**
+     * @brief Create (or transfer) subscription and add all its monitored items.
+     *
+     * Called (in parallel for all subscriptions of a session) from the
+     * session's connect pipeline. If tryTransfer is set, the subscription is
+     * transferred from the previous session; only if that fails, it is
+     * created and its monitored items are added. Timing of all steps is recorded.
+     *
+     * @param tryTransfer  try to transfer the subscription first
+     */
+    void setup(const bool tryTransfer = false);
+
+    /**
+     * @brief Return true if the last setup transferred the subscription.
+     */
+    bool wasTransferred() const { return transferred; }
+
     /**
      * @brief Clear connection to driver level.
      *
@@ -148,6 +191,30 @@ public:
      */
     void clear();
 
+    /**
+     * @brief Move the processing of data change notifications to a thread pool.
+     *
+     * From now on, dataChange only queues the notifications. A job on the
+     * pool decodes them and requests record processing, taking the
+     * notifications of this subscription in order of arrival.
+     *
+     * @param pool  decoder thread pool of the session
+     */
+    void useDecoderPool(epicsThreadPool *pool);
+
+    /**
+     * @brief Queue the connection loss behind the pending notifications.
+     *
+     * When the decoder pool is used, notifications received before the
+     * connection went down may still be waiting. The connection loss is
+     * processed for all items of the subscription after them (in order),
+     * so that old data can not clear the records' INVALID alarm.
+     *
+     * @return true if the connection loss has been queued
+     *         (false = the caller processes it)
+     */
+    bool queueConnectionLoss();
+
     // UaSubscriptionCallback interface
     virtual void subscriptionStatusChanged(
             OpcUa_UInt32      clientSubscriptionHandle,
@@ -164,13 +231,45 @@ public:
             ) override;
 
 private:
+    /**
+     * @brief Add the monitored items with the specified client handles (indices into items).
+     */
+    void addMonitoredItems(const std::vector<OpcUa_UInt32> &handles);
+    /**
+     * @brief Republish notifications of a transferred subscription and process them.
+     */
+    void republish(const UaUInt32Array &sequenceNumbers);
+    /**
+     * @brief Recreate the transferred monitored items of registered nodes.
+     */
+    void recreateRegisteredItems();
+    void processDataChange(const UaDataNotifications &dataNotifications);
+    void scheduleDecoder();
+    void decodeQueued();
+    static void decodeJob(void *arg, epicsJobMode mode);
+
     static std::map<std::string, SubscriptionUaSdk*> subscriptions;
 
     UaSubscription *puasubscription;            /**< pointer to low level subscription */
     SessionUaSdk *psessionuasdk;                /**< pointer to session */
+    unsigned int channel;                       /**< session channel used by the subscription */
     std::vector<ItemUaSdk *> items;             /**< items on this subscription */
     SubscriptionSettings subscriptionSettings;  /**< subscription specific settings */
     bool enable;                                /**< subscription enable flag */
+    OpcUa_UInt32 subscriptionId;                /**< server side id (for transfer to a new session) */
+    bool transferred;                           /**< last setup transferred the subscription */
+    double transferTime;                        /**< duration of last transferSubscription [ms] */
+    double createTime;                          /**< duration of last createSubscription [ms] */
+    double addItemsTime;                        /**< duration of last createMonitoredItems [ms] */
+    size_t republished;                         /**< notifications republished after last transfer */
+    size_t recreatedItems;                      /**< monitored items recreated after last transfer */
+    ProcessingBatch batch;                      /**< batched I/O Intr processing (batch-scan option) */
+    /** notifications waiting for the decoder pool (nullptr = connection loss) */
+    MpscQueue<std::unique_ptr<UaDataNotifications>> incoming;
+    epicsJob *decoder;                          /**< decoder pool job (nullptr = decode in dataChange) */
+    int decoderScheduled;                       /**< decoder job is queued or running */
+    size_t deferred;                            /**< number of notifications passed to the pool */
+    size_t jobQueueFailures;                    /**< number of failed epicsJobQueue calls */
 };
 
 } // namespace DevOpcua
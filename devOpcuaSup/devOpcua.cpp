@@ -79,6 +79,7 @@ using namespace DevOpcua;
     try
 #define CATCH() catch(std::exception& e) { \
     std::cerr << prec->name << " Error : " << e.what() << std::endl; \
+    if (pvt->pdataelement) pvt->clearIncomingData(); \
     (void)recGblSetSevr(prec, COMM_ALARM, INVALID_ALARM); \
     return 1; }
 
@@ -94,12 +95,23 @@ opcua_add_record (dbCommon *prec)
         pvt->plinkinfo = parseLink(prec, ent);
         //TODO: Switch to implementation selection / factory
         if (pvt->plinkinfo->linkedToItem) {
-            pitem = new ItemUaSdk(*pvt->plinkinfo);
+            pitem = ItemUaSdk::findOrCreateItem(*pvt->plinkinfo);
         } else {
             pitem = static_cast<ItemUaSdk *>(pvt->plinkinfo->item);
         }
-        DataElementUaSdk::addElementChain(pitem, pvt.get(), pvt->plinkinfo->element);
+        try {
+            DataElementUaSdk::addElementChain(pitem, pvt.get(), pvt->plinkinfo->element);
+        } catch (...) {
+            if (pvt->plinkinfo->linkedToItem)
+                ItemUaSdk::releaseItem(pitem);
+            throw;
+        }
+        if (pvt->plinkinfo->linkedToItem)
+            pitem->addLink();
         pvt->pitem = pitem;
+        pvt->executor = pitem->processingExecutor();
+        if (pvt->executor)
+            pvt->executor->attach();
         prec->dpvt = pvt.release();
         return 0;
     } catch(std::exception& e) {
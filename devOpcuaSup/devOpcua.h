@@ -53,9 +53,21 @@ typedef struct linkInfo {
     double samplingInterval;
     epicsUInt32 queueSize;
     bool discardOldest = true;
+    double maxAge = 0.0;               /**< max. age of a cached value to serve a read [ms] */
+    epicsUInt32 deadbandType = 0;      /**< 0 = none, 1 = absolute, 2 = percent (OPC UA DeadbandType) */
+    double deadbandValue = 0.0;        /**< deadband (absolute value or percent of EU range) */
+    epicsUInt32 dataChangeTrigger = 1; /**< 0 = status, 1 = +value, 2 = +timestamp (OPC UA DataChangeTrigger) */
 
     std::string element;
     bool useServerTimestamp = true;
+    epicsUInt32 clientQueueSize = 0;   /**< size of the client side value queue (0 = same as qsize) */
+    epicsUInt32 dropDuplicates = 0;    /**< drop unchanged updates: 0 = off, 1 = value+status, 2 = +timestamp */
+    epicsUInt32 packSamples = 0;       /**< pack scalar samples into blocks of that size (0 = off) */
+    double packTime = 0.0;             /**< max. time to fill a block [ms] (0 = no limit) */
+    bool packTimestamps = false;       /**< pack the samples' time stamps instead of values */
+    std::string aggregate;             /**< aggregate function over a window (empty = off) */
+    epicsUInt32 windowSamples = 0;     /**< number of samples in an aggregation window (0 = no limit) */
+    double windowTime = 0.0;           /**< length of an aggregation window [ms] (0 = no limit) */
 
     bool isOutput;
     bool monitor = true;
@@ -124,6 +136,9 @@ public:
     bool isItemRecord() const {
         return !(dbFindField(pentry(), "RTYP") || strcmp(dbGetString(pentry()), "opcuaItem"));
     }
+    bool isRecordType(const char *rtyp) const {
+        return !(dbFindField(pentry(), "RTYP") || strcmp(dbGetString(pentry()), rtyp));
+    }
     const char *info(const char *name, const char *def) const
     {
         if (dbFindInfo(pentry(), name))
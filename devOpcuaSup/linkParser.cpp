@@ -15,6 +15,8 @@
 #include <string>
 #include <cstring>
 #include <cstddef>
+#include <cstdlib>
+#include <iomanip>
 #include <algorithm>
 
 #include <dbCommon.h>
@@ -27,6 +29,7 @@
 #include "iocshVariables.h"
 #include "Subscription.h"
 #include "Session.h"
+#include "Aggregator.h"
 
 namespace DevOpcua {
 
@@ -41,6 +44,78 @@ getYesNo (const char c)
         throw std::runtime_error(SB() << "illegal value '" << c << "'");
 }
 
+// Deadband: "abs:<value>" or "pct:<value>" (or "none")
+static void
+parseDeadband (const std::string &s, linkInfo &info)
+{
+    if (s == "none") {
+        info.deadbandType = 0;
+        info.deadbandValue = 0.0;
+        return;
+    }
+    size_t sep = s.find(':');
+    std::string type = s.substr(0, sep);
+    if (sep == std::string::npos || (type != "abs" && type != "pct"))
+        throw std::runtime_error(SB() << "illegal deadband '" << s << "' (use abs:<value> or pct:<value>)");
+    if (epicsParseDouble(s.substr(sep + 1).c_str(), &info.deadbandValue, nullptr) || info.deadbandValue < 0.0)
+        throw std::runtime_error(SB() << "illegal deadband value in '" << s << "'");
+    info.deadbandType = (type == "abs") ? 1 : 2;
+}
+
+// Duplicate filter: "n" (off), "value" or "timestamp"
+static epicsUInt32
+parseDedup (const std::string &s)
+{
+    if (s == "value")
+        return 1;
+    else if (s == "timestamp")
+        return 2;
+    else if (s.length() && !getYesNo(s[0]))
+        return 0;
+    else
+        throw std::runtime_error(SB() << "illegal value '" << s << "'");
+}
+
+// Data change trigger: "status", "value" or "timestamp"
+static epicsUInt32
+parseTrigger (const std::string &s)
+{
+    if (s == "status")
+        return 0;
+    else if (s == "value")
+        return 1;
+    else if (s == "timestamp")
+        return 2;
+    else
+        throw std::runtime_error(SB() << "illegal trigger '" << s << "'");
+}
+
+std::string
+deadbandString (const linkInfo &info)
+{
+    if (!info.deadbandType)
+        return "none";
+    // Shortest representation that parses back to the same value
+    std::string value;
+    for (int precision = 15; precision <= 17; precision++) {
+        value = SB() << std::setprecision(precision) << info.deadbandValue;
+        if (std::strtod(value.c_str(), nullptr) == info.deadbandValue)
+            break;
+    }
+    return SB() << (info.deadbandType == 1 ? "abs:" : "pct:") << value;
+}
+
+const char *
+triggerString (const epicsUInt32 trigger)
+{
+    switch (trigger) {
+    case 0: return "status";
+    case 1: return "value";
+    case 2: return "timestamp";
+    default: return "?";
+    }
+}
+
 std::unique_ptr<linkInfo>
 parseLink (dbCommon *prec, DBEntry &ent)
 {
@@ -90,6 +165,25 @@ parseLink (dbCommon *prec, DBEntry &ent)
         else
             throw std::runtime_error(SB() << "illegal value '" << s << "'");
 
+    s = ent.info("opcua:MAXAGE", "");
+    if (debug > 19 && s[0] != '\0')
+        std::cerr << prec->name << " info 'opcua:MAXAGE'='" << s << "'" << std::endl;
+    if (s[0] != '\0')
+        if (epicsParseDouble(s, &pinfo->maxAge, nullptr))
+            throw std::runtime_error(SB() << "error converting '" << s << "' to Double");
+
+    s = ent.info("opcua:DEADBAND", "");
+    if (debug > 19 && s[0] != '\0')
+        std::cerr << prec->name << " info 'opcua:DEADBAND'='" << s << "'" << std::endl;
+    if (s[0] != '\0')
+        parseDeadband(s, *pinfo);
+
+    s = ent.info("opcua:TRIGGER", "");
+    if (debug > 19 && s[0] != '\0')
+        std::cerr << prec->name << " info 'opcua:TRIGGER'='" << s << "'" << std::endl;
+    if (s[0] != '\0')
+        pinfo->dataChangeTrigger = parseTrigger(s);
+
     s = ent.info("opcua:TIMESTAMP", "");
     if (debug > 19 && s[0] != '\0')
         std::cerr << prec->name << " info 'opcua:TIMESTAMP'='" << s << "'" << std::endl;
@@ -103,6 +197,59 @@ parseLink (dbCommon *prec, DBEntry &ent)
         else
             throw std::runtime_error(SB() << "illegal value '" << s << "'");
 
+    s = ent.info("opcua:CQSIZE", "");
+    if (debug > 19 && s[0] != '\0')
+        std::cerr << prec->name << " info 'opcua:CQSIZE'='" << s << "'" << std::endl;
+    if (s[0] != '\0')
+        if (epicsParseUInt32(s, &pinfo->clientQueueSize, 0, nullptr))
+            throw std::runtime_error(SB() << "error converting '" << s << "' to UInt32");
+
+    s = ent.info("opcua:DEDUP", "");
+    if (debug > 19 && s[0] != '\0')
+        std::cerr << prec->name << " info 'opcua:DEDUP'='" << s << "'" << std::endl;
+    if (s[0] != '\0')
+        pinfo->dropDuplicates = parseDedup(s);
+
+    s = ent.info("opcua:PACK", "");
+    if (debug > 19 && s[0] != '\0')
+        std::cerr << prec->name << " info 'opcua:PACK'='" << s << "'" << std::endl;
+    if (s[0] != '\0')
+        if (epicsParseUInt32(s, &pinfo->packSamples, 0, nullptr))
+            throw std::runtime_error(SB() << "error converting '" << s << "' to UInt32");
+
+    s = ent.info("opcua:PACKTIME", "");
+    if (debug > 19 && s[0] != '\0')
+        std::cerr << prec->name << " info 'opcua:PACKTIME'='" << s << "'" << std::endl;
+    if (s[0] != '\0')
+        if (epicsParseDouble(s, &pinfo->packTime, nullptr))
+            throw std::runtime_error(SB() << "error converting '" << s << "' to Double");
+
+    s = ent.info("opcua:PACKTS", "");
+    if (debug > 19 && s[0] != '\0')
+        std::cerr << prec->name << " info 'opcua:PACKTS'='" << s << "'" << std::endl;
+    if (s[0] != '\0')
+        pinfo->packTimestamps = getYesNo(s[0]);
+
+    s = ent.info("opcua:AGGREGATE", "");
+    if (debug > 19 && s[0] != '\0')
+        std::cerr << prec->name << " info 'opcua:AGGREGATE'='" << s << "'" << std::endl;
+    if (s[0] != '\0')
+        pinfo->aggregate = s;
+
+    s = ent.info("opcua:WINDOW", "");
+    if (debug > 19 && s[0] != '\0')
+        std::cerr << prec->name << " info 'opcua:WINDOW'='" << s << "'" << std::endl;
+    if (s[0] != '\0')
+        if (epicsParseUInt32(s, &pinfo->windowSamples, 0, nullptr))
+            throw std::runtime_error(SB() << "error converting '" << s << "' to UInt32");
+
+    s = ent.info("opcua:WINDOWTIME", "");
+    if (debug > 19 && s[0] != '\0')
+        std::cerr << prec->name << " info 'opcua:WINDOWTIME'='" << s << "'" << std::endl;
+    if (s[0] != '\0')
+        if (epicsParseDouble(s, &pinfo->windowTime, nullptr))
+            throw std::runtime_error(SB() << "error converting '" << s << "' to Double");
+
     s = ent.info("opcua:READBACK", "");
     if (debug > 19 && s[0] != '\0')
         std::cerr << prec->name << " info 'opcua:READBACK'='" << s << "'" << std::endl;
@@ -204,6 +351,13 @@ parseLink (dbCommon *prec, DBEntry &ent)
                     pinfo->discardOldest = true;
                 else
                     throw std::runtime_error(SB() << "illegal value '" << optval << "'");
+            } else if (optname == "maxage") {
+                if (epicsParseDouble(optval.c_str(), &pinfo->maxAge, nullptr))
+                    throw std::runtime_error(SB() << "error converting '" << optval << "' to Double");
+            } else if (optname == "deadband") {
+                parseDeadband(optval, *pinfo);
+            } else if (optname == "trigger") {
+                pinfo->dataChangeTrigger = parseTrigger(optval);
             } else if (optname == "register") {
                 if (optval.length() > 0) {
                     pinfo->registerNode = getYesNo(optval[0]);
@@ -220,6 +374,31 @@ parseLink (dbCommon *prec, DBEntry &ent)
                 pinfo->useServerTimestamp = false;
             else
                 throw std::runtime_error(SB() << "illegal value '" << optval << "'");
+        } else if (optname == "cqsize") {
+            if (epicsParseUInt32(optval.c_str(), &pinfo->clientQueueSize, 0, nullptr))
+                throw std::runtime_error(SB() << "error converting '" << optval << "' to UInt32");
+        } else if (optname == "dedup") {
+            pinfo->dropDuplicates = parseDedup(optval);
+        } else if (optname == "pack") {
+            if (epicsParseUInt32(optval.c_str(), &pinfo->packSamples, 0, nullptr))
+                throw std::runtime_error(SB() << "error converting '" << optval << "' to UInt32");
+        } else if (optname == "packtime") {
+            if (epicsParseDouble(optval.c_str(), &pinfo->packTime, nullptr))
+                throw std::runtime_error(SB() << "error converting '" << optval << "' to Double");
+        } else if (optname == "packts") {
+            if (optval.length() > 0) {
+                pinfo->packTimestamps = getYesNo(optval[0]);
+            } else {
+                throw std::runtime_error(SB() << "no value for option '" << optname << "'");
+            }
+        } else if (optname == "aggregate") {
+            pinfo->aggregate = optval;
+        } else if (optname == "window") {
+            if (epicsParseUInt32(optval.c_str(), &pinfo->windowSamples, 0, nullptr))
+                throw std::runtime_error(SB() << "error converting '" << optval << "' to UInt32");
+        } else if (optname == "windowtime") {
+            if (epicsParseDouble(optval.c_str(), &pinfo->windowTime, nullptr))
+                throw std::runtime_error(SB() << "error converting '" << optval << "' to Double");
         } else if (optname == "monitor" || optname == "readback") {
             if (optval.length() > 0) {
                 pinfo->monitor = getYesNo(optval[0]);
@@ -247,11 +426,22 @@ parseLink (dbCommon *prec, DBEntry &ent)
                 std::cout << " id(s)=" << pinfo->identifierString;
             std::cout << " sampling=" << pinfo->samplingInterval
                       << " qsize=" << pinfo->queueSize
-                      << " discard=" << (pinfo->discardOldest ? "old" : "new");
+                      << " discard=" << (pinfo->discardOldest ? "old" : "new")
+                      << " maxage=" << pinfo->maxAge
+                      << " deadband=" << deadbandString(*pinfo)
+                      << " trigger=" << triggerString(pinfo->dataChangeTrigger);
         } else {
             std::cout << " element=" << pinfo->element;
         }
         std::cout << " timestamp=" << (pinfo->useServerTimestamp ? "server" : "source")
+                  << " cqsize=" << pinfo->clientQueueSize
+                  << " dedup=" << pinfo->dropDuplicates
+                  << " pack=" << pinfo->packSamples
+                  << " packtime=" << pinfo->packTime
+                  << " packts=" << (pinfo->packTimestamps ? "y" : "n")
+                  << " aggregate=" << pinfo->aggregate
+                  << " window=" << pinfo->windowSamples
+                  << " windowtime=" << pinfo->windowTime
                   << " output=" << (pinfo->isOutput ? "y" : "n")
                   << " monitor=" << (pinfo->monitor ? "y" : "n")
                   << std::endl;
@@ -260,6 +450,22 @@ parseLink (dbCommon *prec, DBEntry &ent)
     // consistency checks
     if (pinfo->isOutput && pinfo->monitor && !pinfo->subscription.length())
         throw std::runtime_error(SB() << "monitoring an output requires a valid subscription");
+    if (pinfo->packSamples
+            && (pinfo->isOutput
+                || !(ent.isRecordType("waveform") || ent.isRecordType("aai"))))
+        throw std::runtime_error(SB() << "packing samples requires a waveform or aai input record");
+    // without monitored updates, blocks and windows would only be filled by reads
+    if (pinfo->packSamples && !pinfo->subscription.length())
+        throw std::runtime_error(SB() << "packing samples requires a valid subscription");
+    if (pinfo->aggregate.length()) {
+        (void) Aggregator::functionFromString(pinfo->aggregate);
+        if (pinfo->isOutput || pinfo->packSamples)
+            throw std::runtime_error(SB() << "aggregation requires an input record without packing");
+        if (!pinfo->subscription.length())
+            throw std::runtime_error(SB() << "aggregation requires a valid subscription");
+        if (!pinfo->windowSamples && pinfo->windowTime <= 0.0)
+            throw std::runtime_error(SB() << "aggregation requires a window (samples or time)");
+    }
 
     return pinfo;
 }
@@ -24,6 +24,10 @@ bool getYesNo(const char c);
 
 std::unique_ptr<linkInfo> parseLink(dbCommon* prec, DBEntry &ent);
 
+// Link option values as accepted by the parser (e.g. "abs:0.5", "value")
+std::string deadbandString(const linkInfo &info);
+const char *triggerString(const epicsUInt32 trigger);
+
 } // namespace DevOpcua
 
 #endif // DEVOPCUA_LINKPARSER_H
@@ -0,0 +1,110 @@
+/*************************************************************************\
+* Copyright (c) 2026 ITER Organization.
+* This module is distributed subject to a Software License Agreement found
+* in file LICENSE that is included with this distribution.
+\*************************************************************************/
+
+/*
+ *  Author: agent <agent@local>
+ */
+
+#include <cmath>
+#include <stdexcept>
+
+#include <gtest/gtest.h>
+
+#include "Aggregator.h"
+
+namespace {
+
+using namespace DevOpcua;
+
+epicsTimeStamp
+stamp (const epicsUInt32 sec)
+{
+    epicsTimeStamp ts;
+    ts.secPastEpoch = sec;
+    ts.nsec = 0;
+    return ts;
+}
+
+// Sample series longer than a chunk, with a tail that does not fill all lanes
+const unsigned int noOfSamples = 203;
+
+double
+sample (const unsigned int i)
+{
+    return std::sin(i * 0.37) * 10.0 + (i % 7);
+}
+
+double
+aggregate (const Aggregator::Function function, epicsTimeStamp &ts)
+{
+    Aggregator aggregator(function, noOfSamples);
+    for (unsigned int i = 0; i < noOfSamples; i++) {
+        EXPECT_FALSE(aggregator.isFull()) << "window full after " << i << " samples";
+        aggregator.add(sample(i), stamp(i));
+    }
+    EXPECT_TRUE(aggregator.isFull()) << "window not full after all samples";
+    return aggregator.take(ts);
+}
+
+TEST(AggregatorTest, FunctionNames) {
+    EXPECT_EQ(Aggregator::functionFromString("rms"), Aggregator::rms);
+    EXPECT_STREQ(Aggregator::functionString(Aggregator::mean), "mean");
+    EXPECT_THROW(Aggregator::functionFromString("median"), std::runtime_error);
+}
+
+TEST(AggregatorTest, Minimum) {
+    double expected = sample(0);
+    for (unsigned int i = 1; i < noOfSamples; i++)
+        expected = std::min(expected, sample(i));
+    epicsTimeStamp ts;
+    EXPECT_EQ(aggregate(Aggregator::min, ts), expected);
+}
+
+TEST(AggregatorTest, Maximum) {
+    double expected = sample(0);
+    for (unsigned int i = 1; i < noOfSamples; i++)
+        expected = std::max(expected, sample(i));
+    epicsTimeStamp ts;
+    EXPECT_EQ(aggregate(Aggregator::max, ts), expected);
+}
+
+TEST(AggregatorTest, Mean) {
+    double sum = 0.0;
+    for (unsigned int i = 0; i < noOfSamples; i++)
+        sum += sample(i);
+    epicsTimeStamp ts;
+    EXPECT_NEAR(aggregate(Aggregator::mean, ts), sum / noOfSamples, 1e-12);
+}
+
+TEST(AggregatorTest, RootMeanSquare) {
+    double sum = 0.0;
+    for (unsigned int i = 0; i < noOfSamples; i++)
+        sum += sample(i) * sample(i);
+    epicsTimeStamp ts;
+    EXPECT_NEAR(aggregate(Aggregator::rms, ts), std::sqrt(sum / noOfSamples), 1e-12);
+}
+
+TEST(AggregatorTest, LastValueAndTimeStamp) {
+    epicsTimeStamp ts;
+    EXPECT_EQ(aggregate(Aggregator::last, ts), sample(noOfSamples - 1));
+    EXPECT_EQ(ts.secPastEpoch, noOfSamples - 1) << "time stamp is not the last sample's";
+}
+
+TEST(AggregatorTest, WindowsAreIndependent) {
+    Aggregator aggregator(Aggregator::max, 0);
+    epicsTimeStamp ts;
+    aggregator.add(5.0, stamp(1));
+    aggregator.add(9.0, stamp(2));
+    EXPECT_FALSE(aggregator.isFull()) << "window without sample limit is full";
+    EXPECT_EQ(aggregator.currentWindow(), 0u);
+    EXPECT_EQ(aggregator.take(ts), 9.0);
+    EXPECT_TRUE(aggregator.isEmpty()) << "taken window not empty";
+    EXPECT_EQ(aggregator.currentWindow(), 1u);
+    aggregator.add(-3.0, stamp(3));
+    EXPECT_EQ(aggregator.take(ts), -3.0) << "previous window leaks into the next";
+}
+
+} // namespace
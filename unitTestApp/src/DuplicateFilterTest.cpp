@@ -0,0 +1,76 @@
+/*************************************************************************\
+* Copyright (c) 2026 ITER Organization.
+* This module is distributed subject to a Software License Agreement found
+* in file LICENSE that is included with this distribution.
+\*************************************************************************/
+
+/*
+ *  Author: agent <agent@local>
+ */
+
+#include <gtest/gtest.h>
+
+#include "DuplicateFilter.h"
+
+namespace {
+
+using namespace DevOpcua;
+
+const epicsUInt32 good = 0;
+const epicsUInt32 bad = 0x80000000;
+
+epicsTimeStamp
+stamp (const epicsUInt32 sec, const epicsUInt32 nsec = 0)
+{
+    epicsTimeStamp ts;
+    ts.secPastEpoch = sec;
+    ts.nsec = nsec;
+    return ts;
+}
+
+TEST(DuplicateFilterTest, FirstUpdateIsHandedOn) {
+    DuplicateFilter<int> filter;
+    EXPECT_FALSE(filter.check(5, good, stamp(1))) << "first update dropped";
+    EXPECT_EQ(filter.noOfDuplicates(), 0);
+}
+
+TEST(DuplicateFilterTest, RepeatedValueIsDropped) {
+    DuplicateFilter<int> filter;
+    filter.check(5, good, stamp(1));
+    EXPECT_TRUE(filter.check(5, good, stamp(2))) << "repeated value not dropped";
+    EXPECT_FALSE(filter.check(6, good, stamp(3))) << "changed value dropped";
+    EXPECT_EQ(filter.noOfDuplicates(), 1);
+}
+
+TEST(DuplicateFilterTest, StatusChangeIsHandedOn) {
+    DuplicateFilter<int> filter;
+    filter.check(5, good, stamp(1));
+    EXPECT_FALSE(filter.check(5, bad, stamp(2))) << "status change dropped";
+    EXPECT_FALSE(filter.check(5, good, stamp(3))) << "status recovery dropped";
+}
+
+TEST(DuplicateFilterTest, TimeStampModeComparesTimeStamps) {
+    DuplicateFilter<int> filter(true);
+    filter.check(5, good, stamp(1, 10));
+    EXPECT_FALSE(filter.check(5, good, stamp(1, 20))) << "new time stamp dropped";
+    EXPECT_TRUE(filter.check(5, good, stamp(1, 20))) << "same time stamp not dropped";
+}
+
+TEST(DuplicateFilterTest, HandedOnValueIsRemembered) {
+    DuplicateFilter<int> filter;
+    filter.handedOn(7, good, stamp(1));
+    EXPECT_TRUE(filter.check(7, good, stamp(2))) << "value after read not dropped";
+}
+
+// Connection loss, then reconnect (or transfer) re-sends the unchanged value
+TEST(DuplicateFilterTest, UnchangedValueAfterConnectionLossIsHandedOn) {
+    DuplicateFilter<int> filter;
+    EXPECT_FALSE(filter.check(5, good, stamp(1)));
+    EXPECT_TRUE(filter.check(5, good, stamp(2)));
+    filter.reset();
+    EXPECT_FALSE(filter.check(5, good, stamp(3))) << "initial value after reconnect dropped";
+    EXPECT_TRUE(filter.check(5, good, stamp(4))) << "filter not active again after reconnect";
+    EXPECT_EQ(filter.noOfDuplicates(), 2);
+}
+
+} // namespace
@@ -0,0 +1,106 @@
+/*************************************************************************\
+* Copyright (c) 2026 ITER Organization.
+* This module is distributed subject to a Software License Agreement found
+* in file LICENSE that is included with this distribution.
+\*************************************************************************/
+
+/*
+ *  Author: agent <agent@local>
+ */
+
+#include <memory>
+#include <vector>
+#include <thread>
+#include <atomic>
+
+#include <gtest/gtest.h>
+
+#include "MpscQueue.h"
+
+namespace {
+
+using namespace DevOpcua;
+
+TEST(MpscQueueTest, EmptyQueue) {
+    MpscQueue<int> queue;
+    int value = 42;
+    EXPECT_TRUE(queue.isEmpty());
+    EXPECT_FALSE(queue.pop(value)) << "empty queue returned a value";
+    EXPECT_EQ(value, 42) << "failed pop changed the output";
+}
+
+TEST(MpscQueueTest, ValuesAreTakenInOrder) {
+    MpscQueue<int> queue;
+    for (int i = 0; i < 5; i++)
+        queue.push(int(i));
+    EXPECT_FALSE(queue.isEmpty());
+    int value;
+    for (int i = 0; i < 5; i++) {
+        ASSERT_TRUE(queue.pop(value));
+        EXPECT_EQ(value, i);
+    }
+    EXPECT_TRUE(queue.isEmpty());
+    EXPECT_FALSE(queue.pop(value));
+}
+
+TEST(MpscQueueTest, MoveOnlyValues) {
+    MpscQueue<std::unique_ptr<int>> queue;
+    queue.push(std::unique_ptr<int>(new int(7)));
+    std::unique_ptr<int> value;
+    ASSERT_TRUE(queue.pop(value));
+    ASSERT_TRUE(value);
+    EXPECT_EQ(*value, 7);
+}
+
+TEST(MpscQueueTest, DestructorReleasesQueuedValues) {
+    std::shared_ptr<int> tracked(new int(1));
+    {
+        MpscQueue<std::shared_ptr<int>> queue;
+        for (int i = 0; i < 3; i++)
+            queue.push(std::shared_ptr<int>(tracked));
+        EXPECT_EQ(tracked.use_count(), 4);
+    }
+    EXPECT_EQ(tracked.use_count(), 1) << "queued values leaked";
+}
+
+// All values of all writers arrive exactly once, each writer's values in order
+TEST(MpscQueueTest, ConcurrentWriters) {
+    const int noOfWriters = 4;
+    const int noOfValues = 100000;
+    MpscQueue<std::pair<int, int>> queue;
+    std::atomic<bool> go(false);
+    std::vector<std::thread> writers;
+
+    for (int w = 0; w < noOfWriters; w++)
+        writers.emplace_back([&queue, &go, w, noOfValues]() {
+            while (!go.load())
+                std::this_thread::yield();
+            for (int i = 0; i < noOfValues; i++)
+                queue.push(std::make_pair(w, i));
+        });
+    go.store(true);
+
+    std::vector<int> next(noOfWriters, 0);
+    int received = 0;
+    bool ordered = true;
+    std::pair<int, int> value;
+    while (received < noOfWriters * noOfValues) {
+        if (queue.pop(value)) {
+            if (value.second != next[value.first])
+                ordered = false;
+            next[value.first] = value.second + 1;
+            received++;
+        } else {
+            std::this_thread::yield();
+        }
+    }
+    for (auto &it : writers)
+        it.join();
+
+    EXPECT_TRUE(ordered) << "values of a writer lost, duplicated or reordered";
+    for (int w = 0; w < noOfWriters; w++)
+        EXPECT_EQ(next[w], noOfValues) << "writer " << w;
+    EXPECT_TRUE(queue.isEmpty()) << "values left after all were received";
+}
+
+} // namespace
@@ -0,0 +1,164 @@
+/*************************************************************************\
+* Copyright (c) 2026 ITER Organization.
+* This module is distributed subject to a Software License Agreement found
+* in file LICENSE that is included with this distribution.
+\*************************************************************************/
+
+/*
+ *  Author: agent <agent@local>
+ */
+
+#include <thread>
+#include <atomic>
+
+#include <gtest/gtest.h>
+
+#include "RingBuffer.h"
+#include "TripleBuffer.h"
+
+namespace {
+
+using namespace DevOpcua;
+
+bool
+put (RingBuffer<int> &ring, const int value)
+{
+    int *slot = ring.claim();
+    if (!slot)
+        return false;
+    *slot = value;
+    ring.publish();
+    return true;
+}
+
+int
+get (RingBuffer<int> &ring)
+{
+    int *value = ring.front();
+    if (!value)
+        return -1;
+    int v = *value;
+    ring.pop();
+    return v;
+}
+
+TEST(RingBufferTest, SizeIsRoundedUp) {
+    RingBuffer<int> ring(5);
+    EXPECT_EQ(ring.capacity(), 8);
+    EXPECT_TRUE(ring.isEmpty());
+    EXPECT_EQ(ring.front(), nullptr) << "empty ring returns a value";
+}
+
+TEST(RingBufferTest, ValuesAreDeliveredInOrderOnce) {
+    RingBuffer<int> ring(4);
+    for (int i = 0; i < 3; i++)
+        EXPECT_TRUE(put(ring, i));
+    EXPECT_EQ(ring.size(), 3);
+    for (int i = 0; i < 3; i++)
+        EXPECT_EQ(get(ring), i);
+    EXPECT_TRUE(ring.isEmpty());
+    EXPECT_EQ(get(ring), -1) << "value delivered twice";
+    EXPECT_EQ(ring.noOfOverflows(), 0);
+}
+
+TEST(RingBufferTest, OverflowDiscardsOldest) {
+    RingBuffer<int> ring(4, true);
+    for (int i = 0; i < 6; i++)
+        EXPECT_TRUE(put(ring, i)) << "new value " << i << " dropped";
+    EXPECT_EQ(ring.noOfOverflows(), 2);
+    for (int i = 2; i < 6; i++)
+        EXPECT_EQ(get(ring), i);
+    EXPECT_TRUE(ring.isEmpty());
+}
+
+TEST(RingBufferTest, OverflowDiscardsNewest) {
+    RingBuffer<int> ring(4, false);
+    for (int i = 0; i < 6; i++)
+        EXPECT_EQ(put(ring, i), i < 4) << "wrong value dropped at " << i;
+    EXPECT_EQ(ring.noOfOverflows(), 2);
+    for (int i = 0; i < 4; i++)
+        EXPECT_EQ(get(ring), i);
+    EXPECT_TRUE(ring.isEmpty());
+}
+
+TEST(RingBufferTest, ValueBeingReadIsNotDropped) {
+    RingBuffer<int> ring(2, true);
+    put(ring, 0);
+    put(ring, 1);
+    int *oldest = ring.front();
+    ASSERT_NE(oldest, nullptr);
+    EXPECT_FALSE(put(ring, 2)) << "value being read was dropped";
+    EXPECT_EQ(*oldest, 0) << "value being read was overwritten";
+    EXPECT_EQ(ring.noOfOverflows(), 1);
+    ring.pop();
+    EXPECT_TRUE(put(ring, 3)) << "no space after pop";
+    EXPECT_EQ(get(ring), 1);
+    EXPECT_EQ(get(ring), 3);
+}
+
+// Every value is either delivered (in order) or counted as overflow
+void
+stress (const bool discardOldest)
+{
+    const int noOfValues = 200000;
+    RingBuffer<int> ring(16, discardOldest);
+    std::atomic<bool> done(false);
+    int received = 0;
+    int last = -1;
+    bool ordered = true;
+
+    std::thread reader([&]() {
+        while (!done.load() || !ring.isEmpty()) {
+            if (int *value = ring.front()) {
+                if (*value <= last)
+                    ordered = false;
+                last = *value;
+                received++;
+                ring.pop();
+            } else {
+                std::this_thread::yield();
+            }
+        }
+    });
+    for (int i = 0; i < noOfValues; i++)
+        put(ring, i);
+    done.store(true);
+    reader.join();
+
+    EXPECT_TRUE(ordered) << "values delivered out of order";
+    EXPECT_EQ(received + ring.noOfOverflows(), noOfValues) << "values lost or duplicated";
+}
+
+TEST(RingBufferTest, ConcurrentWriterAndReaderDiscardOldest) {
+    stress(true);
+}
+
+TEST(RingBufferTest, ConcurrentWriterAndReaderDiscardNewest) {
+    stress(false);
+}
+
+// Element with a value queue: monitored updates are queued, a read result goes to
+// the completion slot and is taken by the read completion, ahead of the queue
+TEST(RingBufferTest, ReadCompletionBypassesQueuedUpdates) {
+    RingBuffer<int> updates(4);
+    TripleBuffer<int> completion;
+
+    EXPECT_TRUE(put(updates, 1));
+    EXPECT_TRUE(put(updates, 2));
+    completion.writeBuffer() = 100;     // read result
+    completion.publish();
+    EXPECT_TRUE(put(updates, 3));
+
+    // readComplete processing
+    ASSERT_TRUE(completion.acquire());
+    EXPECT_EQ(completion.readBuffer(), 100) << "read completion got a queued update";
+    EXPECT_EQ(updates.size(), 3) << "read completion consumed a queued update";
+
+    // incomingData processing for the queued updates
+    for (int i = 1; i <= 3; i++)
+        EXPECT_EQ(get(updates), i);
+    EXPECT_TRUE(updates.isEmpty());
+    EXPECT_FALSE(completion.acquire()) << "read result delivered twice";
+}
+
+} // namespace
@@ -0,0 +1,91 @@
+/*************************************************************************\
+* Copyright (c) 2026 ITER Organization.
+* This module is distributed subject to a Software License Agreement found
+* in file LICENSE that is included with this distribution.
+\*************************************************************************/
+
+/*
+ *  Author: agent <agent@local>
+ */
+
+#include <gtest/gtest.h>
+
+#include <uabase.h>
+#include <uavariant.h>
+#include <uaarraytemplates.h>
+
+#include <epicsTime.h>
+
+#include "SamplePackerUaSdk.h"
+
+namespace {
+
+using namespace DevOpcua;
+
+epicsTimeStamp
+stamp (const epicsUInt32 nsec)
+{
+    epicsTimeStamp ts;
+    ts.secPastEpoch = 1000;
+    ts.nsec = nsec;
+    return ts;
+}
+
+UaVariant
+doubleValue (const OpcUa_Double v)
+{
+    UaVariant value;
+    value.setDouble(v);
+    return value;
+}
+
+TEST(SamplePackerTest, ValuesArePackedInOrder) {
+    SamplePackerUaSdk packer(3, false);
+    EXPECT_TRUE(packer.isEmpty());
+    EXPECT_TRUE(packer.add(doubleValue(1.0), stamp(100)));
+    EXPECT_TRUE(packer.add(doubleValue(2.0), stamp(200)));
+    EXPECT_TRUE(packer.add(doubleValue(3.0), stamp(300)));
+    EXPECT_TRUE(packer.isFull());
+    EXPECT_FALSE(packer.add(doubleValue(4.0), stamp(400))) << "sample added to a full block";
+
+    UaVariant block;
+    UaDoubleArray values;
+    packer.take(block);
+    block.toDoubleArray(values);
+    ASSERT_EQ(values.length(), 3u);
+    for (OpcUa_UInt32 i = 0; i < values.length(); i++)
+        EXPECT_EQ(values[i], i + 1.0);
+    EXPECT_TRUE(packer.isEmpty());
+    EXPECT_EQ(packer.currentBlock(), 1u);
+}
+
+// A rejected first sample must not set the block's time stamp
+TEST(SamplePackerTest, RejectedSampleDoesNotSetFirstTimeStamp) {
+    SamplePackerUaSdk packer(4, false);
+    UaVariant text;
+    text.setString(UaString("not packable"));
+    EXPECT_FALSE(packer.add(text, stamp(100)));
+    EXPECT_TRUE(packer.isEmpty());
+    EXPECT_TRUE(packer.add(doubleValue(1.0), stamp(200)));
+    EXPECT_EQ(packer.firstTimeStamp().nsec, 200u) << "block time stamp taken from a rejected sample";
+}
+
+// Time stamp mode packs the offsets from the first accepted sample
+TEST(SamplePackerTest, TimeStampOffsetsStartAtFirstAcceptedSample) {
+    SamplePackerUaSdk packer(4, true);
+    UaVariant text;
+    text.setString(UaString("not packable"));
+    EXPECT_FALSE(packer.add(text, stamp(100000000)));
+    EXPECT_TRUE(packer.add(doubleValue(1.0), stamp(200000000)));
+    EXPECT_TRUE(packer.add(doubleValue(2.0), stamp(500000000)));
+
+    UaVariant block;
+    UaDoubleArray offsets;
+    packer.take(block);
+    block.toDoubleArray(offsets);
+    ASSERT_EQ(offsets.length(), 2u);
+    EXPECT_DOUBLE_EQ(offsets[0], 0.0);
+    EXPECT_NEAR(offsets[1], 0.3, 1e-9);
+}
+
+} // namespace
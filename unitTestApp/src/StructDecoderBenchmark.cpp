@@ -0,0 +1,157 @@
+/*************************************************************************\
+* Copyright (c) 2026 ITER Organization.
+* This module is distributed subject to a Software License Agreement found
+* in file LICENSE that is included with this distribution.
+\*************************************************************************/
+
+/*
+ *  Author: agent <agent@local>
+ */
+
+#include <iostream>
+#include <vector>
+#include <memory>
+#include <chrono>
+
+#include <gtest/gtest.h>
+
+#include <uabase.h>
+#include <uavariant.h>
+#include <uadatetime.h>
+#include <uaextensionobject.h>
+#include <uastructuredefinition.h>
+#include <uagenericstructurevalue.h>
+
+#include "StructDecoderUaSdk.h"
+
+namespace {
+
+using namespace DevOpcua;
+
+const unsigned int noOfBodies = 1000;   // recorded updates
+const unsigned int noOfRounds = 100;    // decoding passes over all recorded updates
+
+// Structure with scalars, a string and an array (typical status structure)
+UaStructureDefinition
+makeDefinition ()
+{
+    struct { const char *name; OpcUa_BuiltInType type; bool isArray; } fields[] = {
+        { "setpoint",  OpcUaType_Double,   false },
+        { "readback",  OpcUaType_Double,   false },
+        { "low",       OpcUaType_Double,   false },
+        { "high",      OpcUaType_Double,   false },
+        { "counter",   OpcUaType_Int32,    false },
+        { "mode",      OpcUaType_UInt16,   false },
+        { "enabled",   OpcUaType_Boolean,  false },
+        { "message",   OpcUaType_String,   false },
+        { "waveform",  OpcUaType_Double,   true  },
+        { "gain",      OpcUaType_Float,    false },
+        { "errors",    OpcUaType_UInt32,   false },
+        { "updated",   OpcUaType_DateTime, false },
+    };
+    UaStructureDefinition definition;
+    definition.setName("BenchmarkStatus");
+    definition.setDataTypeId(UaNodeId(5001, 1));
+    definition.setBinaryEncodingId(UaNodeId(5002, 1));
+    for (auto &it : fields) {
+        UaStructureField field;
+        field.setName(it.name);
+        field.setDataTypeId(UaNodeId(static_cast<OpcUa_UInt32>(it.type), 0));
+        field.setValueType(it.type);
+        field.setArrayType(it.isArray ? UaStructureField::ArrayType_Array
+                                      : UaStructureField::ArrayType_Scalar);
+        definition.addChild(field);
+    }
+    return definition;
+}
+
+// Encode a series of updates with the SDK, as they arrive from a server
+std::vector<UaExtensionObject>
+recordBodies (const UaStructureDefinition &definition)
+{
+    std::vector<UaExtensionObject> bodies(noOfBodies);
+    UaDoubleArray waveform;
+    waveform.create(64);
+    for (unsigned int i = 0; i < noOfBodies; i++) {
+        UaGenericStructureValue value(definition);
+        UaVariant v;
+        for (int f = 0; f < 4; f++) {
+            v.setDouble(i * 0.5 + f);
+            value.setField(f, v);
+        }
+        v.setInt32(static_cast<OpcUa_Int32>(i));
+        value.setField(4, v);
+        v.setUInt16(static_cast<OpcUa_UInt16>(i % 4));
+        value.setField(5, v);
+        v.setBoolean(i % 2 ? OpcUa_True : OpcUa_False);
+        value.setField(6, v);
+        v.setString(i % 10 ? "running" : "calibrating");
+        value.setField(7, v);
+        for (OpcUa_UInt32 k = 0; k < waveform.length(); k++)
+            waveform[k] = i + k * 0.1;
+        v.setDoubleArray(waveform);
+        value.setField(8, v);
+        v.setFloat(1.5f);
+        value.setField(9, v);
+        v.setUInt32(i / 100);
+        value.setField(10, v);
+        v.setDateTime(UaDateTime::now());
+        value.setField(11, v);
+        value.toExtensionObject(bodies[i]);
+    }
+    return bodies;
+}
+
+double
+elapsed (const std::chrono::steady_clock::time_point &start)
+{
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+// The records map a few fields behind the array (skipped by the plan)
+TEST(StructDecoderBenchmark, PlannedVersusGenericDecoder) {
+    const UaStructureDefinition definition = makeDefinition();
+    const std::vector<int> wanted = { 1, 4, 7, 9 };
+    const std::vector<UaExtensionObject> bodies = recordBodies(definition);
+
+    std::unique_ptr<StructDecoderUaSdk> decoder = StructDecoderUaSdk::compile(definition, wanted);
+    ASSERT_TRUE(decoder) << "no plan for a supported structure";
+
+    // Both decoders must extract the same values
+    std::vector<UaVariant> planned;
+    for (auto &it : bodies) {
+        const OpcUa_ExtensionObject *eo = it;
+        ASSERT_TRUE(decoder->decode(eo->Body.Binary, planned)) << "plan failed to decode a body";
+        UaGenericStructureValue generic(it, definition);
+        for (size_t i = 0; i < wanted.size(); i++)
+            EXPECT_TRUE(planned[i] == generic.value(wanted[i])) << "field " << wanted[i] << " differs";
+    }
+
+    auto start = std::chrono::steady_clock::now();
+    for (unsigned int r = 0; r < noOfRounds; r++)
+        for (auto &it : bodies) {
+            const OpcUa_ExtensionObject *eo = it;
+            decoder->decode(eo->Body.Binary, planned);
+        }
+    const double tPlanned = elapsed(start);
+
+    std::vector<UaVariant> values(wanted.size());
+    start = std::chrono::steady_clock::now();
+    for (unsigned int r = 0; r < noOfRounds; r++)
+        for (auto &it : bodies) {
+            UaGenericStructureValue generic;
+            generic.setGenericValue(it, definition);
+            for (size_t i = 0; i < wanted.size(); i++)
+                values[i] = generic.value(wanted[i]);
+        }
+    const double tGeneric = elapsed(start);
+
+    const double n = static_cast<double>(noOfRounds) * noOfBodies;
+    std::cout << "planned decoder: " << tPlanned / n * 1e9 << " ns/update, "
+              << "generic decoder: " << tGeneric / n * 1e9 << " ns/update, "
+              << "speedup " << (tPlanned > 0.0 ? tGeneric / tPlanned : 0.0) << std::endl;
+    RecordProperty("plannedNsPerUpdate", static_cast<int>(tPlanned / n * 1e9));
+    RecordProperty("genericNsPerUpdate", static_cast<int>(tGeneric / n * 1e9));
+}
+
+} // namespace
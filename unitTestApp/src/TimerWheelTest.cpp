@@ -0,0 +1,131 @@
+/*************************************************************************\
+* Copyright (c) 2026 ITER Organization.
+* This module is distributed subject to a Software License Agreement found
+* in file LICENSE that is included with this distribution.
+\*************************************************************************/
+
+/*
+ *  Author: agent <agent@local>
+ */
+
+#include <vector>
+#include <thread>
+#include <mutex>
+
+#include <gtest/gtest.h>
+
+#include "TimerWheel.h"
+
+namespace {
+
+using namespace DevOpcua;
+
+const double tick = 0.001;
+
+// Collects the expired cargo with its expiry time
+class Collector : public TimerConsumer<int>
+{
+public:
+    void timersExpired(std::vector<int> &expired) override
+    {
+        std::lock_guard<std::mutex> G(lock);
+        for (auto it : expired) {
+            cargo.push_back(it);
+            times.push_back(epicsTime::getCurrent());
+        }
+    }
+
+    // Wait until n timers have expired (or give up)
+    bool waitFor(const size_t n, const double timeout = 5.0)
+    {
+        for (double t = 0.0; t < timeout; t += 0.01) {
+            {
+                std::lock_guard<std::mutex> G(lock);
+                if (cargo.size() >= n)
+                    return true;
+            }
+            epicsThreadSleep(0.01);
+        }
+        return false;
+    }
+
+    std::mutex lock;
+    std::vector<int> cargo;
+    std::vector<epicsTime> times;
+};
+
+TEST(TimerWheelTest, TimersExpireInOrder) {
+    Collector collector;
+    TimerWheel<int> wheel("test", collector, tick);
+    wheel.add(0.05, 2);
+    wheel.add(0.02, 1);
+    wheel.add(0.0, 0);
+    EXPECT_EQ(wheel.size(), 3u);
+    ASSERT_TRUE(collector.waitFor(3));
+    EXPECT_EQ(collector.cargo, std::vector<int>({ 0, 1, 2 }));
+    EXPECT_EQ(wheel.size(), 0u);
+}
+
+TEST(TimerWheelTest, TimerDoesNotExpireEarly) {
+    Collector collector;
+    TimerWheel<int> wheel("test", collector, tick);
+    epicsTime start = epicsTime::getCurrent();
+    wheel.add(0.03, 1);
+    ASSERT_TRUE(collector.waitFor(1));
+    EXPECT_GE(collector.times[0] - start, 0.03 - tick) << "timer expired early";
+}
+
+// Delays beyond the first level (64 ticks) are cascaded down
+TEST(TimerWheelTest, LongDelaysCascade) {
+    Collector collector;
+    TimerWheel<int> wheel("test", collector, tick);
+    epicsTime start = epicsTime::getCurrent();
+    wheel.add(0.2, 2);      // level 1
+    wheel.add(0.01, 1);     // level 0
+    ASSERT_TRUE(collector.waitFor(2));
+    EXPECT_EQ(collector.cargo, std::vector<int>({ 1, 2 }));
+    EXPECT_GE(collector.times[1] - start, 0.2 - tick) << "cascaded timer expired early";
+}
+
+TEST(TimerWheelTest, StopDiscardsTimers) {
+    Collector collector;
+    TimerWheel<int> wheel("test", collector, tick, false);
+    wheel.add(10.0, 1);
+    wheel.startWorker();
+    EXPECT_EQ(wheel.size(), 1u);
+    wheel.stop();
+    EXPECT_EQ(wheel.size(), 0u) << "timers kept after stop";
+    EXPECT_TRUE(collector.cargo.empty()) << "timer expired on stop";
+}
+
+// Timers added concurrently all expire, each exactly once
+TEST(TimerWheelTest, ConcurrentAdders) {
+    const int noOfAdders = 4;
+    const int noOfTimers = 1000;
+    Collector collector;
+    TimerWheel<int> wheel("test", collector, tick);
+    std::vector<std::thread> adders;
+
+    for (int a = 0; a < noOfAdders; a++)
+        adders.emplace_back([&wheel, a, noOfTimers]() {
+            for (int i = 0; i < noOfTimers; i++)
+                wheel.add((i % 50) * tick, a * noOfTimers + i);
+        });
+    for (auto &it : adders)
+        it.join();
+
+    ASSERT_TRUE(collector.waitFor(noOfAdders * noOfTimers));
+    epicsThreadSleep(0.1);
+    std::vector<int> count(noOfAdders * noOfTimers, 0);
+    {
+        std::lock_guard<std::mutex> G(collector.lock);
+        EXPECT_EQ(collector.cargo.size(), count.size()) << "timers expired more than once";
+        for (auto it : collector.cargo)
+            count[it]++;
+    }
+    for (size_t i = 0; i < count.size(); i++)
+        EXPECT_EQ(count[i], 1) << "timer " << i;
+    EXPECT_EQ(wheel.size(), 0u);
+}
+
+} // namespace
@@ -0,0 +1,193 @@
+/*************************************************************************\
+* Copyright (c) 2026 ITER Organization.
+* This module is distributed subject to a Software License Agreement found
+* in file LICENSE that is included with this distribution.
+\*************************************************************************/
+
+/*
+ *  Author: agent <agent@local>
+ */
+
+#include <vector>
+#include <thread>
+#include <atomic>
+#include <mutex>
+
+#include <gtest/gtest.h>
+
+#include "TransactionTable.h"
+
+namespace {
+
+using namespace DevOpcua;
+
+int itemA, itemB;
+
+TEST(TransactionTableTest, CapacityIsRoundedUp) {
+    TransactionTable<int> table(10);
+    EXPECT_EQ(table.capacity(), 16u);
+    EXPECT_EQ(table.inFlight(), 0);
+}
+
+TEST(TransactionTableTest, ReserveActivateClaimRelease) {
+    TransactionTable<int> table(8);
+    std::vector<int *> *items = table.reserve(3);
+    ASSERT_NE(items, nullptr);
+    EXPECT_TRUE(items->empty());
+    items->push_back(&itemA);
+    items->push_back(&itemB);
+    EXPECT_EQ(table.claim(3), nullptr) << "reserved transaction claimed before activation";
+    table.activate(3);
+    EXPECT_EQ(table.inFlight(), 1);
+
+    items = table.claim(3);
+    ASSERT_NE(items, nullptr);
+    ASSERT_EQ(items->size(), 2u);
+    EXPECT_EQ((*items)[0], &itemA);
+    EXPECT_EQ((*items)[1], &itemB);
+    table.release(3);
+    EXPECT_EQ(table.inFlight(), 0);
+    EXPECT_EQ(table.claim(3), nullptr) << "completed transaction claimed again";
+}
+
+TEST(TransactionTableTest, ReleasingReservedSlotKeepsInFlight) {
+    TransactionTable<int> table(8);
+    ASSERT_NE(table.reserve(1), nullptr);
+    table.release(1);      // service call could not be issued
+    EXPECT_EQ(table.inFlight(), 0);
+    EXPECT_NE(table.reserve(1), nullptr) << "slot not freed";
+}
+
+TEST(TransactionTableTest, SlotInUseFailsReserve) {
+    TransactionTable<int> table(4);
+    ASSERT_NE(table.reserve(1), nullptr);
+    EXPECT_EQ(table.reserve(1 + table.capacity()), nullptr) << "slot in use was reserved again";
+    EXPECT_NE(table.reserve(2), nullptr);
+}
+
+TEST(TransactionTableTest, FullTableOverflows) {
+    TransactionTable<int> table(4);
+    for (epicsUInt32 id = 0; id < table.capacity(); id++) {
+        ASSERT_NE(table.reserve(id), nullptr);
+        table.activate(id);
+    }
+    EXPECT_EQ(table.inFlight(), 4);
+    for (epicsUInt32 id = table.capacity(); id < 2 * table.capacity(); id++)
+        EXPECT_EQ(table.reserve(id), nullptr) << "full table reserved id " << id;
+    ASSERT_NE(table.claim(2), nullptr);
+    table.release(2);
+    EXPECT_NE(table.reserve(2 + table.capacity()), nullptr) << "freed slot not reusable";
+}
+
+TEST(TransactionTableTest, StaleIdIsIgnoredAfterReuse) {
+    TransactionTable<int> table(4);
+    const epicsUInt32 stale = 1;
+    const epicsUInt32 reused = stale + table.capacity();
+    table.reserve(stale);
+    table.activate(stale);
+    table.claim(stale);
+    table.release(stale);
+    table.reserve(reused)->push_back(&itemA);
+    table.activate(reused);
+    EXPECT_EQ(table.claim(stale), nullptr) << "stale id claimed the reused slot";
+    std::vector<int *> *items = table.claim(reused);
+    ASSERT_NE(items, nullptr);
+    EXPECT_EQ(items->size(), 1u);
+}
+
+TEST(TransactionTableTest, ActiveIdsByTag) {
+    TransactionTable<int> table(16);
+    std::vector<epicsUInt32> ids;
+    table.reserve(1);
+    table.activate(1, 0);
+    table.reserve(2);
+    table.activate(2, 5);
+    table.reserve(3);
+    table.activate(3, 5);
+    table.reserve(4);      // reserved only
+
+    table.activeIds(5, ids);
+    ASSERT_EQ(ids.size(), 2u);
+    EXPECT_EQ(ids[0], 2u);
+    EXPECT_EQ(ids[1], 3u);
+
+    table.activeIds(0, ids);
+    ASSERT_EQ(ids.size(), 1u) << "reserved transaction reported as active";
+    EXPECT_EQ(ids[0], 1u);
+
+    ASSERT_NE(table.claim(2), nullptr);
+    table.activeIds(5, ids);
+    ASSERT_EQ(ids.size(), 1u) << "claimed transaction reported as active";
+    EXPECT_EQ(ids[0], 3u);
+
+    table.release(2);
+    table.reserve(2 + table.capacity());
+    table.activate(2 + table.capacity(), 7);
+    table.activeIds(5, ids);
+    EXPECT_EQ(ids.size(), 1u) << "reused slot reported with the old tag";
+    table.activeIds(7, ids);
+    ASSERT_EQ(ids.size(), 1u);
+    EXPECT_EQ(ids[0], 2 + table.capacity());
+}
+
+// Requesters reserve and activate, two completers race to claim every transaction
+TEST(TransactionTableTest, ConcurrentRequestersAndCompleters) {
+    const int noOfRequesters = 2;
+    const int noOfCompleters = 2;
+    const int noOfTransactions = 20000;
+    const int total = noOfRequesters * noOfTransactions;
+    TransactionTable<int> table(16);
+    std::atomic<epicsUInt32> nextId(0);
+    std::atomic<int> claims(0);
+    std::atomic<int> badItems(0);
+    std::mutex lock;
+    std::vector<epicsUInt32> issued;
+    std::vector<std::thread> threads;
+
+    for (int r = 0; r < noOfRequesters; r++)
+        threads.emplace_back([&]() {
+            for (int n = 0; n < noOfTransactions; n++) {
+                epicsUInt32 id;
+                std::vector<int *> *items;
+                while (!(items = table.reserve(id = nextId++)))
+                    std::this_thread::yield();
+                items->push_back(&itemA);
+                table.activate(id, id & 1);
+                std::lock_guard<std::mutex> G(lock);
+                issued.push_back(id);
+            }
+        });
+    for (int c = 0; c < noOfCompleters; c++)
+        threads.emplace_back([&]() {
+            size_t seen = 0;
+            while (seen < static_cast<size_t>(total)) {
+                epicsUInt32 id = 0;
+                bool found = false;
+                {
+                    std::lock_guard<std::mutex> G(lock);
+                    if (seen < issued.size()) {
+                        id = issued[seen++];
+                        found = true;
+                    }
+                }
+                if (!found) {
+                    std::this_thread::yield();
+                    continue;
+                }
+                if (std::vector<int *> *items = table.claim(id)) {
+                    if (items->size() != 1 || (*items)[0] != &itemA)
+                        badItems++;
+                    claims++;
+                    table.release(id);
+                }
+            }
+        });
+    for (auto &it : threads)
+        it.join();
+
+    EXPECT_EQ(claims.load(), total) << "transactions claimed twice or lost";
+    EXPECT_EQ(badItems.load(), 0) << "claim returned another transaction's items";
+    EXPECT_EQ(table.inFlight(), 0);
+}
+
+} // namespace
@@ -0,0 +1,114 @@
+/*************************************************************************\
+* Copyright (c) 2026 ITER Organization.
+* This module is distributed subject to a Software License Agreement found
+* in file LICENSE that is included with this distribution.
+\*************************************************************************/
+
+/*
+ *  Author: agent <agent@local>
+ */
+
+#include <thread>
+#include <atomic>
+
+#include <gtest/gtest.h>
+
+#include "TripleBuffer.h"
+
+namespace {
+
+using namespace DevOpcua;
+
+// Two copies of the same number: a torn read shows as a mismatch
+struct Pair {
+    long first = -1;
+    long second = -1;
+};
+
+TEST(TripleBufferTest, NothingNewInitially) {
+    TripleBuffer<int> buffer;
+    EXPECT_FALSE(buffer.hasNew());
+    EXPECT_FALSE(buffer.acquire()) << "acquired a value that was never published";
+}
+
+TEST(TripleBufferTest, PublishedValueIsAcquiredOnce) {
+    TripleBuffer<int> buffer;
+    buffer.writeBuffer() = 1;
+    EXPECT_FALSE(buffer.publish()) << "overwrite reported on first publish";
+    EXPECT_TRUE(buffer.hasNew());
+    EXPECT_TRUE(buffer.acquire());
+    EXPECT_EQ(buffer.readBuffer(), 1);
+    EXPECT_FALSE(buffer.acquire()) << "same value acquired twice";
+    EXPECT_EQ(buffer.readBuffer(), 1) << "front buffer changed without a new value";
+}
+
+TEST(TripleBufferTest, UnconsumedValueIsOverwritten) {
+    TripleBuffer<int> buffer;
+    buffer.writeBuffer() = 1;
+    buffer.publish();
+    buffer.writeBuffer() = 2;
+    EXPECT_TRUE(buffer.publish()) << "overwrite not reported";
+    EXPECT_TRUE(buffer.acquire());
+    EXPECT_EQ(buffer.readBuffer(), 2) << "reader did not get the latest value";
+}
+
+TEST(TripleBufferTest, ReaderKeepsItsBufferWhileWriterPublishes) {
+    TripleBuffer<int> buffer;
+    buffer.writeBuffer() = 1;
+    buffer.publish();
+    buffer.acquire();
+    for (int i = 2; i < 10; i++) {
+        buffer.writeBuffer() = i;
+        buffer.publish();
+        EXPECT_EQ(buffer.readBuffer(), 1) << "writer changed the reader's buffer";
+    }
+    EXPECT_TRUE(buffer.acquire());
+    EXPECT_EQ(buffer.readBuffer(), 9);
+}
+
+// Snapshots are consistent and increasing, every value is acquired or reported overwritten
+TEST(TripleBufferTest, ConcurrentWriterAndReader) {
+    const long noOfValues = 500000;
+    TripleBuffer<Pair> buffer;
+    std::atomic<bool> done(false);
+    long acquired = 0;
+    long overwritten = 0;
+    long last = -1;
+    bool consistent = true;
+    bool ordered = true;
+
+    std::thread reader([&]() {
+        while (true) {
+            bool finished = done.load();
+            if (buffer.acquire()) {
+                const Pair &p = buffer.readBuffer();
+                if (p.first != p.second)
+                    consistent = false;
+                if (p.first <= last)
+                    ordered = false;
+                last = p.first;
+                acquired++;
+            } else if (finished) {
+                break;
+            } else {
+                std::this_thread::yield();
+            }
+        }
+    });
+    for (long i = 0; i < noOfValues; i++) {
+        Pair &p = buffer.writeBuffer();
+        p.first = i;
+        p.second = i;
+        if (buffer.publish())
+            overwritten++;
+    }
+    done.store(true);
+    reader.join();
+
+    EXPECT_TRUE(consistent) << "reader saw a torn value";
+    EXPECT_TRUE(ordered) << "reader saw an older value after a newer one";
+    EXPECT_EQ(last, noOfValues - 1) << "latest value not acquired";
+    EXPECT_EQ(acquired + overwritten, noOfValues) << "values lost without being reported";
+}
+
+} // namespace